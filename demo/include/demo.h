@@ -7,6 +7,8 @@
 #include <GLFW/glfw3.h>
 #include <hybrid_renderer.h>
 
+#include "demo_config.h"
+
 #define DEMO_WINDOW_NAME		"Hybrid Rendering Demo"
 #define DEMO_APP_NAME			"HybridRenderingDemo"
 #define DEMO_APP_VERSION		VK_MAKE_API_VERSION(0, 1, 0, 0)
@@ -19,8 +21,58 @@
 #define BENCHMARK_PATH_TRACER	1
 #define BENCHMARK_T_INTERVAL	1.0f
 
+// Compute tile size benchmark, cycles through all tile sizes in gComputeTileSizes
+#define DO_TILE_SIZE_BENCHMARK				0
+#define TILE_SIZE_BENCHMARK_FRAME_COUNT		500
+
+// Shader pack built from all compiled shaders, see hri::ShaderPack
+#define DEMO_SHADER_PACK_PATH	"shaders/shaders.hsp"
+
+// GBuffer config, rasterize near & far LOD layouts into a layered framebuffer in a single render pass
+#define DEMO_SINGLE_PASS_LOD_GBUFFER		1
+
+// GBuffer config, rasterize (draw instance, primitive) visibility only & resolve the GBuffer targets in a compute pass
+#define DEMO_VISIBILITY_BUFFER_GBUFFER		0
+
+// GBuffer config, DEMO_PACKED_GBUFFER is set by the CMake option of the same name (see demo_config.h)
+
+// GBuffer config, lay out depth in a position only prepass & shade G-buffer targets with an EQUAL depth test
+#define DEMO_DEPTH_PREPASS_GBUFFER			1
+
+// GBuffer config, sample the LOD layouts & resolve deferred shading in a single compute pass, without a sampled GBuffer
+#define DEMO_FUSED_GBUFFER_SHADING			1
+
+// GBuffer config, run GBuffer sampling & deferred shading as subpasses of one render pass, material targets stay transient
+//	(ignored when GBuffer shading is fused)
+#define DEMO_SUBPASS_DEFERRED_SHADING		1
+
+// Shading config, cull emissive instance lights into screen tiles & shade with analytic lighting instead of traced direct illumination
+//	(ignored when deferred shading runs as a subpass)
+#define DEMO_TILED_LIGHT_CULLING			0
+
+// Present config, blit the temporal reprojection result into the swap image instead of running a fullscreen present pass
+//	(falls back to the present pass if the swap image format does not support blit destination use)
+#define DEMO_TEMPORAL_PRESENT_BLIT			1
+
+// Compute config
+#define DEMO_DEFAULT_COMPUTE_TILE_SIZE		8
+#define DEMO_CULL_GROUP_SIZE				64	// Must match local_size_x in gbuffer_culling.glsl
+#define DEMO_HIZ_GROUP_SIZE					8	// Must match local_size_x & local_size_y in gbuffer_hiz.comp
+#define DEMO_HIZ_MAX_MIP_COUNT				16
+#define DEMO_GBUFFER_RESOLVE_GROUP_SIZE		8	// Must match local_size_x & local_size_y in gbuffer_resolve.comp
+#define DEMO_GBUFFER_SHADING_GROUP_SIZE		8	// Must match local_size_x & local_size_y in gbuffer_shading.glsl
+#define DEMO_LIGHT_TILE_SIZE				16	// Must match LIGHT_TILE_SIZE in light_culling.glsl
+#define DEMO_LIGHT_TILE_STRIDE				64	// Must match LIGHT_TILE_STRIDE in light_culling.glsl
+
 // Raytracing config
-#define DEMO_DEFAULT_RT_RECURSION_DEPTH		5
+#define DEMO_DEFAULT_RT_RECURSION_DEPTH		1	// Rays are only traced from ray generation shaders
+#define DEMO_DEFAULT_PT_BOUNCE_COUNT		5
+#define DEMO_MAX_PT_BOUNCE_COUNT			16
+#define DEMO_DEFAULT_PT_SAMPLES_PER_PIXEL	1
+#define DEMO_MAX_PT_SAMPLES_PER_PIXEL		16
+#define DEMO_DEFAULT_PT_ROULETTE_BOUNCE		2	// Bounces traced before paths may be terminated by russian roulette
+#define DEMO_DEFAULT_RT_MAX_PAYLOAD_SIZE	128
+#define DEMO_DEFAULT_RT_MAX_ATTRIBUTE_SIZE	32
 
 #ifndef NDEBUG
 #define DEMO_DEBUG			1
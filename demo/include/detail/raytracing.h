@@ -41,6 +41,15 @@ namespace raytracing
 		RayTracingExtensionDispatchTable rayTracingDispatch = RayTracingExtensionDispatchTable(renderContext);
 	};
 
+	/// @brief A ray tracing pipeline library contains precompiled shader groups that can be linked into ray tracing pipelines.
+	///		The shader stage & group info is kept so linked pipelines can generate their SBT.
+	struct RayTracingPipelineLibrary
+	{
+		VkPipeline pipeline												= VK_NULL_HANDLE;
+		std::vector<VkPipelineShaderStageCreateInfo> shaderStages		= {};
+		std::vector<VkRayTracingShaderGroupCreateInfoKHR> shaderGroups	= {};
+	};
+
 	/// @brief The raytracing pipeline builder manages pipeline create info state for ray tracing pipelines.
 	class RayTracingPipelineBuilder
 	{
@@ -95,16 +104,42 @@ namespace raytracing
 		/// @return A reference to this class.
 		RayTracingPipelineBuilder& setCreateFlags(VkPipelineCreateFlags flags);
 
+		/// @brief Set the library interface used when building or linking pipeline libraries.
+		///		Libraries and the pipelines they are linked into MUST use the same interface.
+		/// @param maxPayloadSize Maximum ray payload size in bytes.
+		/// @param maxHitAttributeSize Maximum hit attribute size in bytes.
+		/// @return A reference to this class.
+		RayTracingPipelineBuilder& setLibraryInterface(
+			uint32_t maxPayloadSize = DEMO_DEFAULT_RT_MAX_PAYLOAD_SIZE,
+			uint32_t maxHitAttributeSize = DEMO_DEFAULT_RT_MAX_ATTRIBUTE_SIZE
+		);
+
+		/// @brief Link a pipeline library into this pipeline, its shader groups are appended after this builder's groups.
+		/// @param library Pipeline library to link.
+		/// @return A reference to this class.
+		RayTracingPipelineBuilder& addLibrary(const RayTracingPipelineLibrary& library);
+
 		/// @brief Build a ray tracing pipeline using the configuration provided.
 		/// @param cache Pipeline cache to use for building.
 		/// @param deferredOperation Deferred Operation handle that allows postponing the actual build operation to a later point in time.
 		/// @return A new vk pipeline handle.
 		VkPipeline build(VkPipelineCache cache = VK_NULL_HANDLE, VkDeferredOperationKHR deferredOperation = VK_NULL_HANDLE);
 
+		/// @brief Build a ray tracing pipeline library using the configuration provided.
+		/// @param cache Pipeline cache to use for building.
+		/// @return A new pipeline library, the pipeline handle is owned by the caller.
+		RayTracingPipelineLibrary buildLibrary(VkPipelineCache cache = VK_NULL_HANDLE);
+
+		/// @brief Get the total number of shader groups, including those of linked libraries.
+		/// @return The shader group count.
+		uint32_t groupCount() const;
+
 		inline const std::vector<VkPipelineShaderStageCreateInfo>& shaderStages() const { return m_shaderStages; }
 
 		inline const std::vector<VkRayTracingShaderGroupCreateInfoKHR>& shaderGroups() const { return m_shaderGroups; }
 
+		inline const std::vector<RayTracingPipelineLibrary>& libraries() const { return m_libraries; }
+
 	private:
 		RayTracingContext& m_ctx;
 		VkPipelineCreateFlags m_flags = 0;
@@ -113,6 +148,9 @@ namespace raytracing
 		uint32_t m_maxRecursionDepth = DEMO_DEFAULT_RT_RECURSION_DEPTH;
 		std::vector<VkDynamicState> m_dynamicStates = {};
 		VkPipelineLayout m_layout = VK_NULL_HANDLE;
+		bool m_useLibraryInterface = false;
+		VkRayTracingPipelineInterfaceCreateInfoKHR m_libraryInterface = VkRayTracingPipelineInterfaceCreateInfoKHR{ VK_STRUCTURE_TYPE_RAY_TRACING_PIPELINE_INTERFACE_CREATE_INFO_KHR };
+		std::vector<RayTracingPipelineLibrary> m_libraries = {};
 	};
 
 	/// @brief The Shader Binding Table is used by a raytracing pipeline to reference its bounds shaders.
@@ -189,6 +227,16 @@ namespace raytracing
 		/// @param pipelineBuilder The pipeline builder containing shader groups.
 		void getShaderGroupIndices(const RayTracingPipelineBuilder& pipelineBuilder);
 
+		/// @brief Append shader group indices for a set of shader groups to the shader group indices array.
+		/// @param shaderStages Shader stages referenced by the shader groups.
+		/// @param shaderGroups Shader groups to append.
+		/// @param groupOffset Offset of the first group in the pipeline's shader group handle array.
+		void appendShaderGroupIndices(
+			const std::vector<VkPipelineShaderStageCreateInfo>& shaderStages,
+			const std::vector<VkRayTracingShaderGroupCreateInfoKHR>& shaderGroups,
+			uint32_t groupOffset
+		);
+
 		/// @brief Fill out the shader group strides array using the group indices.
 		void getShaderGroupStrides();
 
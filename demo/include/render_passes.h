@@ -2,20 +2,27 @@
 
 #include <hybrid_renderer.h>
 #include <memory>
+#include <unordered_map>
 
+#include "demo.h"
 #include "detail/raytracing.h"
 #include "scene.h"
 
+/// @brief Tile sizes (tileSize x tileSize workgroups) available to tiled compute passes.
+constexpr uint32_t gComputeTileSizes[] = { 8, 16 };
+
 /// @brief Common render resources used by subpasses
 struct CommonResources
 {
 	uint32_t frameIndex;
+	uint32_t lightCount;
 	bool accumulate;
 	SceneGraph* activeScene;
 	std::unique_ptr<hri::BufferResource> prevCameraUBO;
 	std::unique_ptr<hri::BufferResource> cameraUBO;
 	hri::BufferResource* instanceDataSSBO;
 	hri::BufferResource* materialSSBO;
+	std::unique_ptr<hri::BufferResource> lightSSBO;	// Scene light list, shared by path tracer NEE & light culling
 	std::vector<raytracing::AccelerationStructure> blasList;
 	std::unique_ptr<raytracing::AccelerationStructure> tlas;
 };
@@ -37,38 +44,6 @@ public:
 	hri_debug::DebugHandler debug = hri_debug::DebugHandler(context);
 };
 
-/// @brief Simple RNG source. White Noise
-class RngGenerationPass
-	:
-	public IRenderPass
-{
-public:
-	struct PushConstantData
-	{
-		uint32_t frameIndex;
-	};
-
-public:
-	RngGenerationPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator);
-
-	virtual ~RngGenerationPass();
-
-	virtual void prepareFrame(CommonResources& resources) override;
-
-	virtual void drawFrame(hri::ActiveFrame& frame, CommonResources& resources) override;
-
-	void recreateResources(VkExtent2D resolution);
-
-public:
-	std::unique_ptr<hri::DescriptorSetLayout> rngDescriptorSetLayout;
-	std::unique_ptr<hri::DescriptorSetManager> rngDescriptorSet;
-	std::unique_ptr<hri::ImageResource> rngSource;
-
-private:
-	VkPipelineLayout m_layout			= VK_NULL_HANDLE;
-	hri::PipelineStateObject* m_pPSO	= nullptr;
-};
-
 /// @brief Path tracing render pass
 class PathTracingPass
 	:
@@ -78,6 +53,11 @@ public:
 	struct PushConstantData
 	{
 		HRI_ALIGNAS(4) uint32_t frameIdx;
+		HRI_ALIGNAS(4) uint32_t maxBounceCount;
+		HRI_ALIGNAS(4) uint32_t rouletteBounceCount;
+		HRI_ALIGNAS(4) uint32_t lightCount;
+		HRI_ALIGNAS(4) uint32_t samplesPerPixel;
+		HRI_ALIGNAS(4) uint32_t accumulatedSampleCount;
 	};
 
 public:
@@ -91,6 +71,9 @@ public:
 
 	void recreateResources(VkExtent2D resolution);
 
+	/// @brief Discard the accumulated samples, the next frame restarts progressive accumulation.
+	inline void resetAccumulation() { m_accumulatedSampleCount = 0; }
+
 public:
 	raytracing::RayTracingContext& rtContext;
 
@@ -105,11 +88,22 @@ public:
 	std::unique_ptr<hri::ImageResource> renderResult;
 	std::unique_ptr<hri::ImageResource> renderNormalResult;
 	std::unique_ptr<hri::ImageResource> renderDepthResult;
+	std::unique_ptr<hri::ImageResource> accumulationResult;	// Running mean of all samples since the last reset
+
+	uint32_t maxBounceCount = DEMO_DEFAULT_PT_BOUNCE_COUNT;
+	uint32_t rouletteBounceCount = DEMO_DEFAULT_PT_ROULETTE_BOUNCE;
+	uint32_t samplesPerPixel = DEMO_DEFAULT_PT_SAMPLES_PER_PIXEL;
+	bool progressiveAccumulation = true;
 
 protected:
+	uint32_t m_accumulatedSampleCount	= 0;
+	VkExtent2D m_allocatedExtent		= VkExtent2D{};	// Over-allocated target extent, see hri::overallocateExtent
 	VkPipelineLayout m_layout			= VK_NULL_HANDLE;
 	hri::PipelineStateObject* m_pPSO	= nullptr;
 	std::unique_ptr<raytracing::ShaderBindingTable> m_SBT;
+	raytracing::RayTracingPipelineLibrary m_rayGenLibrary;
+	raytracing::RayTracingPipelineLibrary m_missLibrary;
+	raytracing::RayTracingPipelineLibrary m_hitLibrary;
 };
 
 /// @brief GBuffer layout render pass
@@ -124,15 +118,56 @@ public:
 		LODFar,
 	};
 
-	struct PushConstantData
+	/// @brief Per draw instance data, written by the culling pass & indexed in the vertex shader using gl_InstanceIndex.
+	struct DrawInstanceData
 	{
 		HRI_ALIGNAS(4)  uint32_t instanceId;
 		HRI_ALIGNAS(4)	uint32_t lodMask;
+		HRI_ALIGNAS(4)	uint32_t layer;
 		HRI_ALIGNAS(16) hri::Float4x4 modelMatrix;
+		HRI_ALIGNAS(16) hri::Float4x4 prevModelMatrix;
+	};
+
+	struct CullPushConstantData
+	{
+		HRI_ALIGNAS(4) uint32_t instanceCount;
+		HRI_ALIGNAS(4) uint32_t meshCount;
+		HRI_ALIGNAS(4) uint32_t passCount;
+		HRI_ALIGNAS(4) uint32_t phase;
+		HRI_ALIGNAS(4) uint32_t useOcclusion;
+		HRI_ALIGNAS(4) uint32_t hiZMipCount;
+		HRI_ALIGNAS(8) hri::Float2 hiZResolution;
 	};
 
+	struct HiZPushConstantData
+	{
+		HRI_ALIGNAS(4) uint32_t mipLevel;
+	};
+
+	// Occlusion culling phases, visible draws are tested against last frame's Hi-Z, occluded draws against the new Hi-Z
+	static constexpr uint32_t CullPhaseVisible = 0;
+	static constexpr uint32_t CullPhaseOccluded = 1;
+
+	// Framebuffer layers of the LOD layouts when rendering in a single pass
+	static constexpr uint32_t LODFarLayer = 0;
+	static constexpr uint32_t LODNearLayer = 1;
+	static constexpr uint32_t LODLayerCount = 2;
+
+	// Render pass indices of the LOD layouts when rendering in 2 passes
+	static constexpr uint32_t LODFarPass = 0;
+	static constexpr uint32_t LODNearPass = 1;
+
+	// Attachment layout, the visibility target only exists in visibility buffer mode
+	static constexpr uint32_t GBufferTargetCount = 6;
+	static constexpr uint32_t DepthAttachment = 6;
+	static constexpr uint32_t VisibilityAttachment = 7;
+
+	// Subpass layout when using a depth prepass, otherwise the G-buffer is rendered in subpass 0
+	static constexpr uint32_t DepthPrepassSubpass = 0;
+	static constexpr uint32_t GBufferSubpass = 1;
+
 public:
-	GBufferLayoutPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator);
+	GBufferLayoutPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator, bool singlePassLOD = DEMO_SINGLE_PASS_LOD_GBUFFER, bool visibilityBuffer = DEMO_VISIBILITY_BUFFER_GBUFFER, bool packedGBuffer = DEMO_PACKED_GBUFFER, bool depthPrepass = DEMO_DEPTH_PREPASS_GBUFFER);
 
 	virtual ~GBufferLayoutPass();
 
@@ -140,20 +175,97 @@ public:
 
 	virtual void drawFrame(hri::ActiveFrame& frame, CommonResources& resources) override;
 
+	/// @brief Get an attachment view of a LOD layout, independent of the active rendering mode.
+	/// @param mode LOD layout to retrieve.
+	/// @param attachmentIndex Attachment index to retrieve.
+	/// @return A 2D image view.
+	VkImageView getLODAttachmentView(LODMode mode, uint32_t attachmentIndex) const;
+
+	/// @brief Recreate the LOD layout pass resources.
+	///		Unlike the compute pass targets these are NOT over-allocated, the LOD layouts & Hi-Z are sampled by UV in most
+	///		consumers (LOD sampling, raytracing hit reconstruction, reprojection), so every resize reallocates them.
+	void recreateResources();
+
 private:
-	void executeGBufferPass(hri::RenderPassResourceManager& resourceManager, hri::ActiveFrame& frame, CommonResources& resources, LODMode mode);
+	/// @brief Create the indirect draw buffers for a scene, draw commands are laid out per pass & mesh.
+	/// @param scene Scene to create draw buffers for.
+	void createDrawBuffers(const SceneGraph& scene);
+
+	/// @brief Create the Hi-Z pyramid for the current resolution & write its descriptor sets.
+	void createHiZResources();
+
+	/// @brief Destroy the per mip Hi-Z views.
+	void destroyHiZResources();
+
+	/// @brief Record the Hi-Z pyramid build from the current LOD layout depth.
+	/// @param frame Active Frame to record into.
+	void buildHiZ(hri::ActiveFrame& frame);
+
+	/// @brief Record GPU culling & draw command generation for all render instances.
+	/// @param frame Active Frame to record into.
+	/// @param phase Occlusion culling phase, CullPhaseVisible or CullPhaseOccluded.
+	void executeCullPass(hri::ActiveFrame& frame, uint32_t phase);
+
+	void executeGBufferPass(hri::RenderPassResourceManager& resourceManager, hri::ActiveFrame& frame, CommonResources& resources, uint32_t passIndex, bool loadAttachments, const char* label);
+
+	/// @brief Record the visibility buffer resolve into the G-buffer targets of both LOD layouts.
+	/// @param frame Active Frame to record into.
+	void executeResolvePass(hri::ActiveFrame& frame);
 
 public:
 	std::unique_ptr<hri::DescriptorSetLayout> sceneDescriptorSetLayout;
 	std::unique_ptr<hri::DescriptorSetManager> sceneDescriptorSet;
+	std::unique_ptr<hri::DescriptorSetLayout> cullDescriptorSetLayout;
+	std::unique_ptr<hri::DescriptorSetManager> cullDescriptorSet;
+	std::unique_ptr<hri::DescriptorSetLayout> hiZDescriptorSetLayout;
+	std::vector<std::unique_ptr<hri::DescriptorSetManager>> hiZDescriptorSets;
+	std::unique_ptr<hri::DescriptorSetLayout> resolveDescriptorSetLayout;
+	std::vector<std::unique_ptr<hri::DescriptorSetManager>> resolveDescriptorSets;	// Indexed by LOD layer
+
+	// Culling input, uploaded every frame
+	std::unique_ptr<hri::BufferResource> renderInstanceSSBO;
+
+	// GPU generated draws, draw command slots are indexed as (passIndex * meshCount + meshIndex)
+	std::unique_ptr<hri::BufferResource> drawCommandTemplates;
+	std::unique_ptr<hri::BufferResource> drawCommandSSBO;
+	std::unique_ptr<hri::BufferResource> visibleDrawCommandSSBO;
+	std::unique_ptr<hri::BufferResource> drawCountSSBO;
+	std::unique_ptr<hri::BufferResource> drawInstanceSSBO;
+
+	// Occlusion culling, draws rejected by the first phase are listed as (instanceIdx * 2 + isNear)
+	std::unique_ptr<hri::BufferResource> occludedDrawSSBO;
+	std::unique_ptr<hri::ImageResource> hiZPyramid;
+	std::unique_ptr<hri::ImageSampler> nearestSampler;
 
 	// 2 passes in one, for near & far LODs
 	std::unique_ptr<hri::RenderPassResourceManager> loDefLODPassResources;
 	std::unique_ptr<hri::RenderPassResourceManager> hiDefLODPassResources;
 
+	// Single pass for near & far LODs, layered by LOD
+	std::unique_ptr<hri::RenderPassResourceManager> layeredLODPassResources;
+
 protected:
+	bool m_singlePassLOD = false;
+	bool m_visibilityBuffer = false;
+	bool m_packedGBuffer = false;
+	bool m_depthPrepass = false;
+	uint32_t m_passCount = 0;
+	uint32_t m_meshCount = 0;
+	uint32_t m_renderInstanceCount = 0;
+	uint32_t m_hiZMipCount = 0;
+	bool m_hiZValid = false;
+	std::vector<VkImageView> m_hiZMipViews = {};
+	VkRenderPass m_loadRenderPass = VK_NULL_HANDLE;
 	VkPipelineLayout m_layout = VK_NULL_HANDLE;
+	VkPipelineLayout m_cullLayout = VK_NULL_HANDLE;
+	VkPipelineLayout m_hiZLayout = VK_NULL_HANDLE;
+	VkPipelineLayout m_resolveLayout = VK_NULL_HANDLE;
 	hri::PipelineStateObject* m_pPSO = nullptr;
+	hri::PipelineStateObject* m_pDepthPrepassPSO = nullptr;
+	hri::PipelineStateObject* m_pCullPSO = nullptr;
+	hri::PipelineStateObject* m_pCompactPSO = nullptr;
+	hri::PipelineStateObject* m_pHiZPSO = nullptr;
+	hri::PipelineStateObject* m_pResolvePSO = nullptr;
 };
 
 /// @brief GBuffer sample pass that samples 2 GBuffer layouts and blends between them using stochastic sampling
@@ -164,14 +276,29 @@ class GBufferSamplePass
 public:
 	struct PushConstantData
 	{
-		HRI_ALIGNAS(16) hri::Float2 resolution;
+		HRI_ALIGNAS(8) hri::Float2 resolution;
+		HRI_ALIGNAS(4) uint32_t frameIndex;
 	};
 
+	// Subpass & attachment indices, the shading subpass & result only exist when deferred shading runs as a subpass
+	static constexpr uint32_t SampleSubpass = 0;
+	static constexpr uint32_t ShadingSubpass = 1;
+	static constexpr uint32_t VelocityAttachment = 6;
+	static constexpr uint32_t ShadingResultAttachment = 7;
+
 public:
-	GBufferSamplePass(hri::RenderContext& context, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator);
+	GBufferSamplePass(
+		hri::RenderContext& context,
+		hri::ShaderDatabase& shaderDB,
+		hri::DescriptorSetAllocator& descriptorAllocator,
+		bool packedGBuffer = DEMO_PACKED_GBUFFER,
+		bool deferredSubpass = DEMO_SUBPASS_DEFERRED_SHADING
+	);
 
 	virtual ~GBufferSamplePass();
 
+	virtual void prepareFrame(CommonResources& resources) override;
+
 	virtual void drawFrame(hri::ActiveFrame& frame, CommonResources& resources) override;
 
 public:
@@ -179,20 +306,24 @@ public:
 	std::unique_ptr<hri::ImageSampler> passInputSampler;
 
 	// Descriptor set layouts
-	std::unique_ptr<hri::DescriptorSetLayout> rngDescriptorSetLayout;
 	std::unique_ptr<hri::DescriptorSetLayout> gbufferSampleDescriptorSetLayout;
+	std::unique_ptr<hri::DescriptorSetLayout> shadingDescriptorSetLayout;
 
-	// Descriptor sets
-	std::unique_ptr<hri::DescriptorSetManager> rngDescriptorSet;
+	// Descriptor sets, the shading set binds the subpass inputs & Direct Illumination input (binding 3)
 	std::unique_ptr<hri::DescriptorSetManager> loDefDescriptorSet;
 	std::unique_ptr<hri::DescriptorSetManager> hiDefDescriptorSet;
+	std::unique_ptr<hri::DescriptorSetManager> shadingDescriptorSet;
 
 	// Pass resources
 	std::unique_ptr<hri::RenderPassResourceManager> passResources;
 
 protected:
-	VkPipelineLayout m_layout			= VK_NULL_HANDLE;
-	hri::PipelineStateObject* m_pPSO	= nullptr;
+	bool m_packedGBuffer						= false;
+	bool m_deferredSubpass						= false;
+	VkPipelineLayout m_layout					= VK_NULL_HANDLE;
+	VkPipelineLayout m_shadingLayout			= VK_NULL_HANDLE;
+	hri::PipelineStateObject* m_pPSO			= nullptr;
+	hri::PipelineStateObject* m_pShadingPSO		= nullptr;
 };
 
 /// @brief Direct illumination ray tracing pass
@@ -201,7 +332,13 @@ class DirectIlluminationPass
 	public IRenderPass
 {
 public:
-	DirectIlluminationPass(raytracing::RayTracingContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator);
+	struct PushConstantData
+	{
+		HRI_ALIGNAS(4) uint32_t frameIdx;
+	};
+
+public:
+	DirectIlluminationPass(raytracing::RayTracingContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator, bool sampleLODGBuffers = DEMO_FUSED_GBUFFER_SHADING);
 
 	virtual ~DirectIlluminationPass();
 
@@ -221,17 +358,24 @@ public:
 	std::unique_ptr<hri::DescriptorSetLayout> gbufferDataDescriptorSetLayout;
 	std::unique_ptr<hri::DescriptorSetLayout> rtDescriptorSetLayout;
 
-	// Descriptor sets
+	// Descriptor sets, the LOD layout sets replace the sampled G-buffer set when sampling LOD layouts directly
 	std::unique_ptr<hri::DescriptorSetManager> gbufferDataDescriptorSet;
+	std::unique_ptr<hri::DescriptorSetManager> loDefDescriptorSet;
+	std::unique_ptr<hri::DescriptorSetManager> hiDefDescriptorSet;
 	std::unique_ptr<hri::DescriptorSetManager> rtDescriptorSet;
 
 	// Image handles
 	std::unique_ptr<hri::ImageResource> renderResult;
 
 protected:
+	bool m_sampleLODGBuffers = false;
+	VkExtent2D m_allocatedExtent = VkExtent2D{};
 	VkPipelineLayout m_layout = VK_NULL_HANDLE;
 	hri::PipelineStateObject* m_pPSO = nullptr;
 	std::unique_ptr<raytracing::ShaderBindingTable> m_SBT;
+	raytracing::RayTracingPipelineLibrary m_rayGenLibrary;
+	raytracing::RayTracingPipelineLibrary m_missLibrary;
+	raytracing::RayTracingPipelineLibrary m_hitLibrary;
 };
 
 /// @brief Deferred shading pass, combines sampled GBuffer & Direct Illumination pass for a final render result
@@ -240,7 +384,12 @@ class DeferredShadingPass
 	public IRenderPass
 {
 public:
-	DeferredShadingPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator);
+	DeferredShadingPass(
+		hri::RenderContext& ctx,
+		hri::ShaderDatabase& shaderDB,
+		hri::DescriptorSetAllocator& descriptorAllocator,
+		const hri::DescriptorSetLayout* lightListSetLayout = nullptr
+	);
 
 	virtual ~DeferredShadingPass();
 
@@ -253,11 +402,107 @@ public:
 	// Descriptor set stuff
 	std::unique_ptr<hri::DescriptorSetLayout> inputDescriptorSetLayout;
 	std::unique_ptr<hri::DescriptorSetManager> inputDescriptorSet;
+	VkDescriptorSet lightListSet = VK_NULL_HANDLE;	// Light culling pass set, only bound when shading with tiled lights
 
-	// Pass resources
-	std::unique_ptr<hri::RenderPassResourceManager> passResources;
+	// Pass resources, the shading result is over-allocated & MUST be read using texel coordinates
+	std::unique_ptr<hri::DynamicRenderingResourceManager> passResources;
 
 protected:
+	bool m_tiledLights = false;
+	VkPipelineLayout m_layout = VK_NULL_HANDLE;
+	hri::PipelineStateObject* m_pPSO = nullptr;
+};
+
+/// @brief Fused GBuffer shading pass, samples 2 GBuffer layouts & resolves deferred shading with Direct Illumination in a single
+///		compute dispatch. Replaces the GBuffer sample & deferred shading passes, the Direct Illumination pass MUST sample the LOD layouts.
+class GBufferShadingPass
+	:
+	public IRenderPass
+{
+public:
+	struct PushConstantData
+	{
+		HRI_ALIGNAS(8) hri::Float2 resolution;
+		HRI_ALIGNAS(4) uint32_t frameIndex;
+	};
+
+public:
+	GBufferShadingPass(
+		hri::RenderContext& ctx,
+		hri::ShaderDatabase& shaderDB,
+		hri::DescriptorSetAllocator& descriptorAllocator,
+		const hri::DescriptorSetLayout* lightListSetLayout = nullptr
+	);
+
+	virtual ~GBufferShadingPass();
+
+	virtual void prepareFrame(CommonResources& resources) override;
+
+	virtual void drawFrame(hri::ActiveFrame& frame, CommonResources& resources) override;
+
+	void recreateResources(VkExtent2D resolution);
+
+public:
+	// Pass sampler
+	std::unique_ptr<hri::ImageSampler> passInputSampler;
+
+	// Descriptor set layouts
+	std::unique_ptr<hri::DescriptorSetLayout> gbufferSampleDescriptorSetLayout;
+	std::unique_ptr<hri::DescriptorSetLayout> shadingDescriptorSetLayout;
+
+	// Descriptor sets, the shading set binds the Direct Illumination input (binding 0) & pass outputs
+	std::unique_ptr<hri::DescriptorSetManager> loDefDescriptorSet;
+	std::unique_ptr<hri::DescriptorSetManager> hiDefDescriptorSet;
+	std::unique_ptr<hri::DescriptorSetManager> shadingDescriptorSet;
+	VkDescriptorSet lightListSet = VK_NULL_HANDLE;	// Light culling pass set, only bound when shading with tiled lights
+
+	// Image handles, normal, depth & velocity of the selected LOD are kept for temporal reprojection
+	std::unique_ptr<hri::ImageResource> renderResult;
+	std::unique_ptr<hri::ImageResource> renderNormal;
+	std::unique_ptr<hri::ImageResource> renderDepth;
+	std::unique_ptr<hri::ImageResource> renderVelocity;
+
+protected:
+	bool m_tiledLights = false;
+	VkExtent2D m_allocatedExtent = VkExtent2D{};
+	VkPipelineLayout m_layout = VK_NULL_HANDLE;
+	hri::PipelineStateObject* m_pPSO = nullptr;
+};
+
+/// @brief Light culling pass, culls the scene's emissive instances into per screen tile light lists. Shading passes bind
+///		the light list set to evaluate only the lights affecting a pixel's tile, replacing the traced direct illumination.
+class LightCullingPass
+	:
+	public IRenderPass
+{
+public:
+	struct PushConstantData
+	{
+		HRI_ALIGNAS(8) hri::Float2 resolution;
+		HRI_ALIGNAS(4) uint32_t lightCount;
+	};
+
+public:
+	LightCullingPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator);
+
+	virtual ~LightCullingPass();
+
+	virtual void prepareFrame(CommonResources& resources) override;
+
+	virtual void drawFrame(hri::ActiveFrame& frame, CommonResources& resources) override;
+
+	void recreateResources(VkExtent2D resolution);
+
+public:
+	// Light list set, written by the culling pass & read by shading passes (camera, scene lights, tile light lists)
+	std::unique_ptr<hri::DescriptorSetLayout> lightListDescriptorSetLayout;
+	std::unique_ptr<hri::DescriptorSetManager> lightListDescriptorSet;
+
+	// Tile light lists hold a tile info header followed by a light count & indices per tile
+	std::unique_ptr<hri::BufferResource> tileLightSSBO;
+
+protected:
+	VkExtent2D m_allocatedExtent = VkExtent2D{};
 	VkPipelineLayout m_layout = VK_NULL_HANDLE;
 	hri::PipelineStateObject* m_pPSO = nullptr;
 };
@@ -271,10 +516,34 @@ public:
 	{
 		HRI_ALIGNAS(4) uint32_t accumulate;
 		HRI_ALIGNAS(8) hri::Float2 resolution;
+		HRI_ALIGNAS(4) uint32_t previousFrameIndex;
+		HRI_ALIGNAS(4) uint32_t currentFrameIndex;
+		HRI_ALIGNAS(4) uint32_t previousNormalIndex;
+		HRI_ALIGNAS(4) uint32_t reprojectHistoryIndex;
+		HRI_ALIGNAS(4) uint32_t renderResultIndex;
+		HRI_ALIGNAS(4) uint32_t renderNormalIndex;
+		HRI_ALIGNAS(4) uint32_t renderDepthIndex;
+		HRI_ALIGNAS(4) uint32_t renderVelocityIndex;
+	};
+
+	/// @brief Bindless sampled image indices of the pass inputs. Without a velocity input the previous position is
+	///		reconstructed from depth & the previous camera, which is only valid for static geometry.
+	struct InputIndices
+	{
+		uint32_t renderResult	= HRI_BINDLESS_INVALID_INDEX;
+		uint32_t renderNormal	= HRI_BINDLESS_INVALID_INDEX;
+		uint32_t renderDepth	= HRI_BINDLESS_INVALID_INDEX;
+		uint32_t renderVelocity	= HRI_BINDLESS_INVALID_INDEX;
 	};
 
 public:
-	TemporalReprojectPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator);
+	TemporalReprojectPass(
+		hri::RenderContext& ctx,
+		hri::ShaderDatabase& shaderDB,
+		hri::DescriptorSetAllocator& descriptorAllocator,
+		hri::BindlessDescriptorSet& bindlessSet,
+		bool presentBlit = DEMO_TEMPORAL_PRESENT_BLIT
+	);
 
 	virtual ~TemporalReprojectPass();
 
@@ -286,10 +555,14 @@ public:
 
 	inline VkImageView getRenderResultView() const { return result[activeFrame]->view; };
 
+	inline uint32_t getRenderResultIndex() const { return m_resultSampledIndices[activeFrame]; };
+
 public:
 	std::unique_ptr<hri::ImageSampler> passInputSampler;
 	std::unique_ptr<hri::DescriptorSetLayout> inputDescriptorSetLayout;
 	std::unique_ptr<hri::DescriptorSetManager> inputDescriptorSet;
+	InputIndices inputIndices = InputIndices{};
+	uint32_t tileSize = DEMO_DEFAULT_COMPUTE_TILE_SIZE;
 
 	u32 activeFrame = 0;
 	std::unique_ptr<hri::ImageResource> normalHistory;
@@ -297,8 +570,16 @@ public:
 	std::unique_ptr<hri::ImageResource> result[2];
 
 protected:
+	hri::BindlessDescriptorSet& m_bindlessSet;
+	uint32_t m_normalHistoryIndex			= HRI_BINDLESS_INVALID_INDEX;
+	uint32_t m_reprojectHistoryIndex		= HRI_BINDLESS_INVALID_INDEX;
+	uint32_t m_resultStorageIndices[2]		= { HRI_BINDLESS_INVALID_INDEX, HRI_BINDLESS_INVALID_INDEX };
+	uint32_t m_resultSampledIndices[2]		= { HRI_BINDLESS_INVALID_INDEX, HRI_BINDLESS_INVALID_INDEX };
+	bool m_presentBlit						= false;	// Blit the result into the active swap image, replaces the present pass
+	std::vector<VkImage> m_swapImages		= {};
+	VkExtent2D m_allocatedExtent			= VkExtent2D{};
 	VkPipelineLayout m_layout = VK_NULL_HANDLE;
-	hri::PipelineStateObject* m_pPSO = nullptr;
+	std::unordered_map<uint32_t, hri::PipelineStateObject*> m_tiledPSOs = {};
 };
 
 /// @brief Present pass, draws an image to a window surface
@@ -307,19 +588,24 @@ struct PresentPass
 	public IRenderPass
 {
 public:
-	PresentPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator);
+	struct PushConstantData
+	{
+		HRI_ALIGNAS(4) uint32_t renderResultIndex;
+	};
+
+public:
+	PresentPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::BindlessDescriptorSet& bindlessSet);
 
 	virtual ~PresentPass();
 
 	virtual void drawFrame(hri::ActiveFrame& frame, CommonResources& resources) override;
 
 public:
-	std::unique_ptr<hri::ImageSampler> passInputSampler;
-	std::unique_ptr<hri::DescriptorSetLayout> presentDescriptorSetLayout;
-	std::unique_ptr<hri::DescriptorSetManager> presentDescriptorSet;
-	std::unique_ptr<hri::SwapchainPassResourceManager> passResources;
+	uint32_t renderResultIndex = HRI_BINDLESS_INVALID_INDEX;
+	std::unique_ptr<hri::DynamicRenderingResourceManager> passResources;
 
 protected:
+	hri::BindlessDescriptorSet& m_bindlessSet;
 	VkPipelineLayout m_layout			= VK_NULL_HANDLE;
 	hri::PipelineStateObject* m_pPSO	= nullptr;
 };
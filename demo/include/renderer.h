@@ -9,6 +9,12 @@
 
 class Renderer
 {
+public:
+	struct ComputePassTimings
+	{
+		float temporalReproject;
+	};
+
 public:
 	Renderer(raytracing::RayTracingContext& ctx, hri::Camera& camera, SceneGraph& activeScene);
 
@@ -20,14 +26,26 @@ public:
 
 	void drawFrame();
 
+	/// @brief Restart progressive path tracer accumulation, e.g. after settings changed.
+	void resetAccumulation();
+
+	ComputePassTimings getComputePassTimings() const;
+
 private:
 	void initRenderPasses();
 
+	void storeBindlessPassInputs();
+
 	void recreateSwapDependentResources(const vkb::Swapchain& swapchain);
 
 public:
 	bool usePathTracer = true;
 	bool useTemporalAccumulation = false;
+	uint32_t computeTileSize = DEMO_DEFAULT_COMPUTE_TILE_SIZE;
+	uint32_t pathTracerBounceCount = DEMO_DEFAULT_PT_BOUNCE_COUNT;
+	uint32_t pathTracerRouletteBounceCount = DEMO_DEFAULT_PT_ROULETTE_BOUNCE;
+	uint32_t pathTracerSamplesPerPixel = DEMO_DEFAULT_PT_SAMPLES_PER_PIXEL;
+	bool useProgressiveAccumulation = true;
 
 private:
 	hri::RenderContext& m_context;
@@ -35,6 +53,7 @@ private:
 	hri::RenderCore m_renderCore;
 	hri::ShaderDatabase m_shaderDatabase;
 	hri::DescriptorSetAllocator m_descriptorSetAllocator;
+	hri::BindlessDescriptorSet m_bindlessDescriptorSet;
 	hri::CommandPool m_computePool;
 	hri::CommandPool m_stagingPool;
 	hri_debug::DebugHandler m_asBuildTimer;
@@ -42,18 +61,25 @@ private:
 
 	// Renderer state
 	uint32_t m_frameCounter;
+	bool m_fusedGBufferShading;
+	bool m_subpassDeferredShading;
+	bool m_temporalPresentBlit;
+	bool m_tiledLightCulling;
 	hri::Camera m_prevCamera;
 	hri::Camera& m_camera;
 	SceneGraph& m_activeScene;
 	CommonResources m_frameResources;
+	TemporalReprojectPass::InputIndices m_pathTracerTemporalInputs;
+	TemporalReprojectPass::InputIndices m_hybridTemporalInputs;
 
 	// Render passes
-	std::unique_ptr<RngGenerationPass> m_rngGenPass;
 	std::unique_ptr<PathTracingPass> m_pathTracingPass;
 	std::unique_ptr<GBufferLayoutPass> m_gbufferLayoutPass;
 	std::unique_ptr<GBufferSamplePass> m_gbufferSamplePass;
 	std::unique_ptr<DirectIlluminationPass> m_directIlluminationPass;
 	std::unique_ptr<DeferredShadingPass> m_deferredShadingPass;
+	std::unique_ptr<GBufferShadingPass> m_gbufferShadingPass;
+	std::unique_ptr<LightCullingPass> m_lightCullingPass;
 	std::unique_ptr<TemporalReprojectPass> m_temporalReprojectPass;
 	std::unique_ptr<PresentPass> m_presentPass;
 	std::unique_ptr<UIPass> m_uiPass;
@@ -10,8 +10,9 @@
 #define MAX_LOD_LEVELS		3
 #define INSTANCE_MASK_BITS	8
 #define VALID_MASK			((1 << INSTANCE_MASK_BITS) - 1)
+#define LIGHT_INFLUENCE_CUTOFF	1e-2f	// Irradiance below which a light no longer affects a surface
 
-#define MESH_RAYTRACING_BUFFER_FLAGS	(VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR)
+#define MESH_RAYTRACING_BUFFER_FLAGS	(VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | VK_BUFFER_USAGE_TRANSFER_SRC_BIT)
 
 /// @brief Scene parameters allow modifying LOD selection.
 struct SceneParameters
@@ -50,15 +51,24 @@ struct SceneNode
 struct RenderInstance
 {
 	hri::Float4x4 modelMatrix;
+	hri::Float4x4 prevModelMatrix;	// Last frame's model matrix, used for motion vectors
 	float lodBlendFactor;
 	uint32_t instanceIdLOD0;
 	uint32_t instanceIdLOD1;
 };
 
-/// @brief A LightArrayEntry is an index pointing to a light's mesh, used for importance sampling scene lights.
+/// @brief A LightArrayEntry describes an emissive render instance as a spherical light, used for light culling & sampling scene lights.
 struct LightArrayEntry
 {
-	uint32_t lightIdx;
+	HRI_ALIGNAS(16) hri::Float4 positionRadius;	// World space bounding sphere of the light's mesh
+	HRI_ALIGNAS(16) hri::Float4 emissionRange;	// Emitted radiance, w is the range at which the light's contribution is culled
+	HRI_ALIGNAS(16) hri::Float4x4 transform;	// Model matrix of the light's render instance
+	HRI_ALIGNAS(4) uint32_t lightIdx;			// Render instance index of the light
+	HRI_ALIGNAS(4) uint32_t instanceIdLOD0;		// Instance data index of the high detail mesh
+	HRI_ALIGNAS(4) uint32_t instanceIdLOD1;		// Instance data index of the low detail mesh
+	HRI_ALIGNAS(4) uint32_t lodMask;			// Ray mask bits for which the low detail mesh is visible
+	HRI_ALIGNAS(4) float selectionPdf;			// Probability of selecting this light when sampling by power
+	HRI_ALIGNAS(4) float selectionCdf;			// Cumulative selection probability up to & including this light
 };
 
 /// @brief Render Instance Data contains offsets into scene buffers & buffer addresses for objects.
@@ -66,8 +76,11 @@ struct RenderInstanceData
 {
 	uint32_t materialIdx;
 	uint32_t indexCount;
+	uint32_t firstIndex;				// First index in the scene index buffer
+	int32_t vertexOffset;				// Vertex offset in the scene vertex buffer
 	VkDeviceAddress vertexBufferAddress;
 	VkDeviceAddress indexBufferAddress;
+	hri::Float4 boundingSphere;			// Local space bounding sphere, xyz center & w radius
 };
 
 /// @brief Scene buffers store device local resources for a scene
@@ -75,6 +88,9 @@ struct SceneBuffers
 {
 	hri::BufferResource instanceDataSSBO;
 	hri::BufferResource materialSSBO;
+	hri::BufferResource vertexBuffer;	// All scene meshes' vertices, allows drawing any mesh without rebinding
+	hri::BufferResource positionBuffer;	// All scene meshes' vertex positions, position only stream for depth only passes
+	hri::BufferResource indexBuffer;	// All scene meshes' indices
 };
 
 /// @brief The Scene Acceleration Structure Manager abstracts away some tedious setup for acceleration structure building.
@@ -188,6 +204,10 @@ public:
 	/// @return A newly generated list of render instances.
 	const std::vector<RenderInstance>& generateRenderInstanceList(const hri::Camera& camera);
 
+	/// @brief Retrieve the light list generated alongside the latest render instance list.
+	/// @return Lights for all emissive render instances.
+	inline const std::vector<LightArrayEntry>& getLightList() const { return m_lights; }
+
 	inline const RenderInstanceData& getInstanceData(size_t idx) const { return m_instanceData.at(idx); }
 
 	static inline uint32_t generateLODMask(const RenderInstance& instance) { return (1 << static_cast<uint32_t>((INSTANCE_MASK_BITS + 1) * instance.lodBlendFactor)) - 1; }
@@ -213,6 +233,7 @@ private:
 	raytracing::RayTracingContext& m_ctx;
 	std::vector<RenderInstanceData> m_instanceData	= {};
 	std::vector<RenderInstance> m_instances			= {};
+	std::vector<LightArrayEntry> m_lights			= {};
 };
 
 /// @brief The SceneLoader handles loading scene files from disk.
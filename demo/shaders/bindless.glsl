@@ -0,0 +1,25 @@
+#ifndef BINDLESS_GLSL
+#define BINDLESS_GLSL
+
+/// Shared include file for the global bindless descriptor set (hri::BindlessDescriptorSet)
+/// Including shaders must enable GL_EXT_nonuniform_qualifier for runtime sized descriptor arrays
+
+// Set index of the bindless set, define before including if a pass binds it at a different index
+#ifndef BINDLESS_SET
+#define BINDLESS_SET	0
+#endif
+
+// Binding indices mirror hri::BindlessResourceType
+#define BINDLESS_SAMPLED_IMAGE_BINDING	0
+#define BINDLESS_STORAGE_IMAGE_BINDING	1
+#define BINDLESS_STORAGE_BUFFER_BINDING	2
+
+#define BINDLESS_INVALID_INDEX			0xFFFFFFFF
+
+layout(set = BINDLESS_SET, binding = BINDLESS_SAMPLED_IMAGE_BINDING) uniform sampler2D BindlessSampledImages[];
+
+// Storage images require a matching format qualifier, so each used format aliases the same binding
+layout(set = BINDLESS_SET, binding = BINDLESS_STORAGE_IMAGE_BINDING, rgba32f) uniform image2D BindlessStorageImages[];
+layout(set = BINDLESS_SET, binding = BINDLESS_STORAGE_IMAGE_BINDING, rg32f) uniform image2D BindlessStorageImagesRG32F[];
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef DEFERRED_SHADING_GLSL
+#define DEFERRED_SHADING_GLSL
+
+/// Deferred shading from the sampled G-buffer.
+/// Includers define DEFERRED_SHADING_TILED_LIGHTS, if set the tiled light lists are evaluated instead of the direct illumination result.
+
+#extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+
+#include "raytracing_common.glsl"
+
+#if DEFERRED_SHADING_TILED_LIGHTS == 1
+#define LIGHT_LIST_SET	1
+#include "light_culling.glsl"
+#endif
+
+layout(location = 0) in vec2 ScreenUV;
+
+layout(location = 0) out vec4 FragColor;
+
+layout(set = 0, binding = 0) uniform sampler2D GBufferAlbedo;
+layout(set = 0, binding = 1) uniform sampler2D GBufferEmission;
+layout(set = 0, binding = 2) uniform sampler2D GBufferSpecular;
+layout(set = 0, binding = 3) uniform sampler2D GBufferTransmittance;
+layout(set = 0, binding = 4) uniform sampler2D GBufferNormal;
+layout(set = 0, binding = 5) uniform sampler2D GBufferDepth;
+layout(set = 0, binding = 6) uniform sampler2D DirectIllumination;
+
+void main()
+{
+// TODO: PBR deferred shading using DI & GBuffer data
+#if DEFERRED_SHADING_TILED_LIGHTS == 1
+	// Analytic lighting from the lights culled into this pixel's tile replaces the traced direct illumination
+	HybridInitialHit hit = getInitialHitData(lightingCamera.invView, lightingCamera.invProject, ScreenUV, GBufferNormal, GBufferDepth);
+	vec3 DI = hit.miss ? vec3(0) : evaluateTiledLights(ivec2(gl_FragCoord.xy), hit.worldPos, hit.worldNormal);
+#else
+	vec3 DI = texelFetch(DirectIllumination, ivec2(gl_FragCoord.xy), 0).rgb;	// DI should be resolved BRDF, over-allocated so fetched by pixel
+#endif
+	vec3 albedo = texture(GBufferAlbedo, ScreenUV).rgb;
+	vec3 emission = texture(GBufferEmission, ScreenUV).rgb;
+	float depth = texture(GBufferDepth, ScreenUV).r;
+
+	vec3 outColor = resolveHybridShading(albedo, emission, depth, DI);
+	FragColor = vec4(outColor, 1);
+}
+
+#endif
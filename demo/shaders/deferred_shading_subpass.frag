@@ -0,0 +1,27 @@
+#version 450
+
+#extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+
+#include "raytracing_common.glsl"
+
+/// Deferred shading as the second subpass of the GBuffer sample render pass, GBuffer data is read on-tile
+
+layout(location = 0) in vec2 ScreenUV;
+
+layout(location = 0) out vec4 FragColor;
+
+layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInput GBufferAlbedo;
+layout(input_attachment_index = 1, set = 0, binding = 1) uniform subpassInput GBufferEmission;
+layout(input_attachment_index = 2, set = 0, binding = 2) uniform subpassInput GBufferDepth;
+layout(set = 0, binding = 3) uniform sampler2D DirectIllumination;
+
+void main()
+{
+	vec3 DI = texelFetch(DirectIllumination, ivec2(gl_FragCoord.xy), 0).rgb;	// Over-allocated, so fetched by pixel
+	vec3 albedo = subpassLoad(GBufferAlbedo).rgb;
+	vec3 emission = subpassLoad(GBufferEmission).rgb;
+	float depth = subpassLoad(GBufferDepth).r;
+
+	vec3 outColor = resolveHybridShading(albedo, emission, depth, DI);
+	FragColor = vec4(outColor, 1);
+}
@@ -0,0 +1,5 @@
+#version 450
+
+// Deferred shading with analytic lighting from the tiled light lists
+#define DEFERRED_SHADING_TILED_LIGHTS 1
+#include "deferred_shading.glsl"
@@ -0,0 +1,29 @@
+#version 450
+
+#extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+#extension GL_ARB_shader_viewport_layer_array : require
+
+#include "shader_common.glsl"
+
+/// Depth only prepass, reads the position only vertex stream. gl_Position must match static.vert exactly
+/// so the G-buffer pass can depth test with EQUAL.
+
+layout(location = 0) in vec3 VertexPosition;
+
+layout(set = 0, binding = 0) uniform CAMERA
+{
+    Camera camera;
+};
+
+layout(set = 0, binding = 3) readonly buffer DRAW_INSTANCE_DATA { InstanceInfo drawInstances[]; };
+
+invariant gl_Position;
+
+void main()
+{
+    InstanceInfo instanceInfo = drawInstances[gl_InstanceIndex];
+    vec4 wPos = instanceInfo.model * vec4(VertexPosition, 1);
+
+    gl_Position = camera.viewProject * wPos;
+    gl_Layer = int(instanceInfo.layer);
+}
@@ -0,0 +1,97 @@
+#ifndef DI_RAYGEN_GLSL
+#define DI_RAYGEN_GLSL
+
+/// Direct illumination ray generation, shared by di.rgen & di_lod.rgen.
+/// Includers define DI_SAMPLE_LOD_GBUFFERS, if set the G-buffer LOD layouts are sampled directly instead of the sampled G-buffer.
+
+#extension GL_EXT_ray_tracing : require
+#extension GL_EXT_scalar_block_layout : enable
+#extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+#extension GL_EXT_buffer_reference2 : require
+
+#include "../shader_common.glsl"
+#include "../raytracing_common.glsl"
+
+layout(location = 0) rayPayloadEXT DIRayPayload prd;
+
+#if DI_SAMPLE_LOD_GBUFFERS == 1
+// The ray tracing set stays at index 1, so the hit & miss shaders are shared between both variants
+#define GBUFFER_LOD_LO_SET	0
+#define GBUFFER_LOD_HI_SET	2
+#include "../gbuffer_lod_sampling.glsl"
+#else
+layout(set = 0, binding = 0) uniform sampler2D GBufferAlbedo;
+layout(set = 0, binding = 1) uniform sampler2D GBufferEmission;
+layout(set = 0, binding = 2) uniform sampler2D GBufferSpecular;
+layout(set = 0, binding = 3) uniform sampler2D GBufferTransmittance;
+layout(set = 0, binding = 4) uniform sampler2D GBufferNormal;
+layout(set = 0, binding = 5) uniform sampler2D GBufferDepth;
+#endif
+
+layout(set = 1, binding = 0) uniform CAMERA { Camera camera; };
+layout(set = 1, binding = 1) uniform accelerationStructureEXT TLAS;
+layout(set = 1, binding = 2, rgba32f) uniform writeonly image2D DirectIlluminationOut;
+
+layout(push_constant) uniform FRAME_INFO { FrameInfo frameInfo; };
+
+void main()
+{
+	// Calculate launch & pixel info
+	const vec2 pixelLocation = gl_LaunchIDEXT.xy;
+	const vec2 pixelCenter = pixelLocation + vec2(0.5);
+	const vec2 inUV = pixelCenter / vec2(gl_LaunchSizeEXT.xy);
+
+	// init payload
+	prd.seed = initPixelSeed(gl_LaunchIDEXT.xy, frameInfo.frameIndex, RNG_SALT_HYBRID_LOD);
+	prd.rayMask = generateRayMask(prd.seed);
+	prd.lightInstanceID = 0;
+	prd.energy = vec3(0);
+	prd.transmission = vec3(1);
+
+#if DI_SAMPLE_LOD_GBUFFERS == 1
+	// Same ray mask as the G-buffer shading pass, so both select the same LOD for this pixel
+	GBufferSample gbufferSample = sampleGBufferLODs(inUV, prd.rayMask);
+	HybridInitialHit hit = getInitialHitData(camera.invView, camera.invProject, inUV, gbufferSample.normal.xyz, gbufferSample.depth);
+	Material material = Material(
+		gbufferSample.albedo.rgb,
+		gbufferSample.specular.rgb,
+		gbufferSample.transmittance.rgb,
+		gbufferSample.emission.rgb,
+		gbufferSample.specular.a,
+		gbufferSample.transmittance.a
+	);
+#else
+	HybridInitialHit hit = getInitialHitData(camera.invView, camera.invProject, inUV, GBufferNormal, GBufferDepth);
+	Material material = getMaterialFromGBuffer(inUV, GBufferAlbedo, GBufferSpecular, GBufferTransmittance, GBufferEmission);
+#endif
+
+	if (luminance(material.emission) < 0.1 && !hit.miss)
+	{
+		bool specularEvent = false;
+		vec3 Wo = vec3(0);
+
+		// The G-buffer stores no tangents, the sampling basis is built from the normal alone
+		randomWalk(prd.seed, hit.Wi, hit.worldNormal, material, Wo, specularEvent);
+
+		float pdf = evaluatePDF(Wo, hit.worldNormal, material, specularEvent);
+		vec3 brdf = evaluateBRDFNoAlbedo(hit.Wi, Wo, hit.worldNormal, material, specularEvent);
+		prd.transmission *= pdf * brdf;
+
+		// Trace random bounce
+		traceRayEXT(
+			TLAS,
+			gl_RayFlagsOpaqueEXT,
+			prd.rayMask,
+			0, 0, 0,
+			hit.worldPos,
+			RAYTRACE_RANGE_TMIN,
+			Wo,
+			RAYTRACE_RANGE_TMAX,
+			0
+		);
+	}
+
+	imageStore(DirectIlluminationOut, ivec2(gl_LaunchIDEXT.xy), vec4(prd.energy, 1.0));
+}
+
+#endif
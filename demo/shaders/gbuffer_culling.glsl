@@ -0,0 +1,52 @@
+#ifndef GBUFFER_CULLING_GLSL
+#define GBUFFER_CULLING_GLSL
+
+/// Shared declarations for the GBuffer culling & draw compaction passes
+
+#include "shader_common.glsl"
+
+// Must match DEMO_CULL_GROUP_SIZE
+layout(local_size_x = 64) in;
+
+// Mirrors RenderInstance from scene.h
+struct RenderInstance
+{
+	mat4 model;
+	mat4 prevModel;
+	float lodBlendFactor;
+	uint instanceIdLOD0;
+	uint instanceIdLOD1;
+};
+
+// Mirrors VkDrawIndexedIndirectCommand
+struct DrawIndexedIndirectCommand
+{
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int vertexOffset;
+	uint firstInstance;
+};
+
+layout(set = 0, binding = 0) uniform CAMERA { Camera camera; };
+layout(set = 0, binding = 1, scalar) readonly buffer RENDER_INSTANCE_DATA { RenderInstanceData instanceData[]; };
+layout(set = 0, binding = 2, scalar) readonly buffer RENDER_INSTANCES { RenderInstance renderInstances[]; };
+layout(set = 0, binding = 3) buffer DRAW_COMMANDS { DrawIndexedIndirectCommand drawCommands[]; };
+layout(set = 0, binding = 4) writeonly buffer VISIBLE_DRAW_COMMANDS { DrawIndexedIndirectCommand visibleDrawCommands[]; };
+layout(set = 0, binding = 5) buffer DRAW_COUNTS { uint drawCounts[]; };
+layout(set = 0, binding = 6) writeonly buffer DRAW_INSTANCE_DATA { InstanceInfo drawInstances[]; };
+layout(set = 0, binding = 7) uniform sampler2D hiZPyramid;
+layout(set = 0, binding = 8) buffer OCCLUDED_DRAWS { uint occludedCount; uint occludedDraws[]; };
+
+layout(push_constant) uniform CULL_PARAMS
+{
+	uint instanceCount;
+	uint meshCount;
+	uint passCount;
+	uint phase;
+	uint useOcclusion;
+	uint hiZMipCount;
+	vec2 hiZResolution;
+};
+
+#endif // GBUFFER_CULLING_GLSL
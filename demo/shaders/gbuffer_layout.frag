@@ -6,12 +6,18 @@
 #extension GL_EXT_buffer_reference2 : require
 
 #include "shader_common.glsl"
+#include "gbuffer_packing.glsl"
 
 layout(location = 0) in VS_OUT
 {
     vec4 wPos;
     vec3 normal;
     vec2 texCoord;
+    flat uint instanceId;
+    flat uint lodMask;
+    flat uint drawInstanceIdx;
+    vec4 clipPos;
+    vec4 prevClipPos;
 } fs_in;
 
 layout(location = 0) out vec4 FragAlbedo;
@@ -21,11 +27,6 @@ layout(location = 3) out vec4 FragTransmittance;
 layout(location = 4) out vec4 FragNormal;
 layout(location = 5) out vec4 FragLODMask;
 
-layout(push_constant) uniform INSTANCE_INFO
-{
-    InstanceInfo instanceInfo;
-};
-
 layout(buffer_reference, scalar) buffer VERTEX_DATA { Vertex vertices[]; };
 layout(buffer_reference, scalar) buffer INDEX_DATA { uint indices[]; };
 
@@ -34,13 +35,13 @@ layout(set = 0, binding = 2) buffer MATERIAL_DATA { Material materials[]; };
 
 void main()
 {
-    RenderInstanceData instance = instances[instanceInfo.instanceId];
+    RenderInstanceData instance = instances[fs_in.instanceId];
     Material material = materials[instance.materialIdx];
 
     FragAlbedo = vec4(material.diffuse, 1);
     FragEmission = vec4(material.emission, 1);
-    FragSpecular = vec4(material.specular, material.shininess);
-    FragTransmittance = vec4(material.transmittance, material.ior);
-    FragNormal = vec4(normalize(fs_in.normal), 1);
-    FragLODMask = vec4(instanceInfo.lodMask);
+    FragSpecular = encodeSpecular(material.specular, material.shininess);
+    FragTransmittance = encodeTransmittance(material.transmittance, material.ior);
+    FragNormal = encodeNormalVelocity(normalize(fs_in.normal), screenVelocity(fs_in.clipPos, fs_in.prevClipPos));
+    FragLODMask = vec4(fs_in.lodMask);
 }
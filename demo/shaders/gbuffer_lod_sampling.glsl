@@ -0,0 +1,82 @@
+#ifndef GBUFFER_LOD_SAMPLING_GLSL
+#define GBUFFER_LOD_SAMPLING_GLSL
+
+/// Stochastic LOD layout selection, shared by the G-buffer sample pass & the fused G-buffer shading path.
+/// Includers define GBUFFER_LOD_LO_SET & GBUFFER_LOD_HI_SET, each set binds one LOD layout's targets in attachment order.
+
+#include "gbuffer_packing.glsl"
+
+layout(set = GBUFFER_LOD_LO_SET, binding = 0) uniform sampler2D GBufferLoAlbedo;
+layout(set = GBUFFER_LOD_LO_SET, binding = 1) uniform sampler2D GBufferLoEmission;
+layout(set = GBUFFER_LOD_LO_SET, binding = 2) uniform sampler2D GBufferLoSpecular;
+layout(set = GBUFFER_LOD_LO_SET, binding = 3) uniform sampler2D GBufferLoTransmittance;
+layout(set = GBUFFER_LOD_LO_SET, binding = 4) uniform sampler2D GBufferLoNormal;
+layout(set = GBUFFER_LOD_LO_SET, binding = 5) uniform sampler2D GBufferLoLODMask;
+layout(set = GBUFFER_LOD_LO_SET, binding = 6) uniform sampler2D GBufferLoDepth;
+
+layout(set = GBUFFER_LOD_HI_SET, binding = 0) uniform sampler2D GBufferHiAlbedo;
+layout(set = GBUFFER_LOD_HI_SET, binding = 1) uniform sampler2D GBufferHiEmission;
+layout(set = GBUFFER_LOD_HI_SET, binding = 2) uniform sampler2D GBufferHiSpecular;
+layout(set = GBUFFER_LOD_HI_SET, binding = 3) uniform sampler2D GBufferHiTransmittance;
+layout(set = GBUFFER_LOD_HI_SET, binding = 4) uniform sampler2D GBufferHiNormal;
+layout(set = GBUFFER_LOD_HI_SET, binding = 5) uniform sampler2D GBufferHiLODMask;
+layout(set = GBUFFER_LOD_HI_SET, binding = 6) uniform sampler2D GBufferHiDepth;
+
+// Decoded G-buffer data of the selected LOD layout
+struct GBufferSample
+{
+	vec4 albedo;
+	vec4 emission;
+	vec4 specular;
+	vec4 transmittance;
+	vec4 normal;
+	vec2 velocity;	// Screen space (UV) motion since the previous frame
+	float depth;
+};
+
+/// @brief Select & sample a LOD layout for a pixel, the ray mask MUST be generated from the RNG_SALT_HYBRID_LOD pixel seed
+///		so all passes select the same LOD layout for a pixel.
+GBufferSample sampleGBufferLODs(vec2 uv, uint rayMask)
+{
+	uint LODLoDefMask = uint(texture(GBufferLoLODMask, uv).r);
+	uint LODHiDefMask = uint(texture(GBufferHiLODMask, uv).r);
+	float LODLoDefDepth = texture(GBufferLoDepth, uv).r;
+	float LODHiDefDepth = texture(GBufferHiDepth, uv).r;
+
+	// Check based on depth which level should be sampled first, fall back to the other level if it is masked out
+	bool sampleLoFirst = LODLoDefDepth < LODHiDefDepth;
+	bool sampleLo = sampleLoFirst ? ((LODLoDefMask & rayMask) != 0) : ((LODHiDefMask & rayMask) == 0);
+
+	GBufferSample gbufferSample;
+	if (sampleLo)
+	{
+		gbufferSample.albedo = texture(GBufferLoAlbedo, uv);
+		gbufferSample.emission = texture(GBufferLoEmission, uv);
+		gbufferSample.specular = texture(GBufferLoSpecular, uv);
+		gbufferSample.transmittance = texture(GBufferLoTransmittance, uv);
+		gbufferSample.normal = texture(GBufferLoNormal, uv);
+		gbufferSample.depth = LODLoDefDepth;
+	}
+	else
+	{
+		gbufferSample.albedo = texture(GBufferHiAlbedo, uv);
+		gbufferSample.emission = texture(GBufferHiEmission, uv);
+		gbufferSample.specular = texture(GBufferHiSpecular, uv);
+		gbufferSample.transmittance = texture(GBufferHiTransmittance, uv);
+		gbufferSample.normal = texture(GBufferHiNormal, uv);
+		gbufferSample.depth = LODHiDefDepth;
+	}
+
+	// Decode the LOD layout targets, albedo & emission are decoded by their formats
+	gbufferSample.velocity = gbufferSample.normal.zw;
+	if (gbufferSample.depth < 1.0)
+	{
+		gbufferSample.specular = decodeSpecular(gbufferSample.specular);
+		gbufferSample.transmittance = decodeTransmittance(gbufferSample.transmittance);
+		gbufferSample.normal = vec4(decodeNormal(gbufferSample.normal.xy), 0);
+	}
+
+	return gbufferSample;
+}
+
+#endif
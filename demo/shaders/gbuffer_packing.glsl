@@ -0,0 +1,80 @@
+#ifndef GBUFFER_PACKING_GLSL
+#define GBUFFER_PACKING_GLSL
+
+/// G-buffer target encoding, shared by the layout, resolve & sample passes.
+/// Material parameters are only quantized for the packed formats, normals are always octahedral since velocity shares their target.
+
+// Packing mode is generated from the DEMO_PACKED_GBUFFER CMake option, shared with the host formats
+#include "../include/demo_config.h"
+
+// Material parameter ranges stored in normalized 8 bit channels
+#define GBUFFER_MAX_SHININESS	1000.0
+#define GBUFFER_MIN_IOR			1.0
+#define GBUFFER_MAX_IOR			3.0
+
+vec2 signNotZero(vec2 v)
+{
+	return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// Octahedral normal encoding in [-1, 1]
+vec2 encodeNormal(vec3 normal)
+{
+	vec2 octahedral = normal.xy / (abs(normal.x) + abs(normal.y) + abs(normal.z));
+	return (normal.z <= 0.0) ? (1.0 - abs(octahedral.yx)) * signNotZero(octahedral) : octahedral;
+}
+
+vec3 decodeNormal(vec2 encoded)
+{
+	vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	if (normal.z < 0.0)
+		normal.xy = (1.0 - abs(normal.yx)) * signNotZero(normal.xy);
+
+	return normalize(normal);
+}
+
+// Normal target layout, octahedral normal in xy & screen space (UV) velocity in zw
+vec4 encodeNormalVelocity(vec3 normal, vec2 velocity)
+{
+	return vec4(encodeNormal(normal), clamp(velocity, -1.0, 1.0));
+}
+
+// Specular color & shininess, shininess is stored with a square root curve for more precision at low values
+vec4 encodeSpecular(vec3 specular, float shininess)
+{
+#if DEMO_PACKED_GBUFFER == 1
+	return vec4(clamp(specular, 0.0, 1.0), sqrt(clamp(shininess / GBUFFER_MAX_SHININESS, 0.0, 1.0)));
+#else
+	return vec4(specular, shininess);
+#endif
+}
+
+vec4 decodeSpecular(vec4 encoded)
+{
+#if DEMO_PACKED_GBUFFER == 1
+	return vec4(encoded.rgb, encoded.a * encoded.a * GBUFFER_MAX_SHININESS);
+#else
+	return encoded;
+#endif
+}
+
+// Transmittance color & index of refraction
+vec4 encodeTransmittance(vec3 transmittance, float ior)
+{
+#if DEMO_PACKED_GBUFFER == 1
+	return vec4(clamp(transmittance, 0.0, 1.0), clamp((ior - GBUFFER_MIN_IOR) / (GBUFFER_MAX_IOR - GBUFFER_MIN_IOR), 0.0, 1.0));
+#else
+	return vec4(transmittance, ior);
+#endif
+}
+
+vec4 decodeTransmittance(vec4 encoded)
+{
+#if DEMO_PACKED_GBUFFER == 1
+	return vec4(encoded.rgb, mix(GBUFFER_MIN_IOR, GBUFFER_MAX_IOR, encoded.a));
+#else
+	return encoded;
+#endif
+}
+
+#endif // GBUFFER_PACKING_GLSL
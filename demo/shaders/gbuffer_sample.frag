@@ -7,25 +7,11 @@
 
 #include "shader_common.glsl"
 
-layout(location = 0) in vec2 ScreenUV;
-
-layout(set = 0, binding = 0) uniform sampler2D RNGSource;
-
-layout(set = 1, binding = 0) uniform sampler2D GBufferLoAlbedo;
-layout(set = 1, binding = 1) uniform sampler2D GBufferLoEmission;
-layout(set = 1, binding = 2) uniform sampler2D GBufferLoSpecular;
-layout(set = 1, binding = 3) uniform sampler2D GBufferLoTransmittance;
-layout(set = 1, binding = 4) uniform sampler2D GBufferLoNormal;
-layout(set = 1, binding = 5) uniform sampler2D GBufferLoLODMask;
-layout(set = 1, binding = 6) uniform sampler2D GBufferLoDepth;
+#define GBUFFER_LOD_LO_SET	0
+#define GBUFFER_LOD_HI_SET	1
+#include "gbuffer_lod_sampling.glsl"
 
-layout(set = 2, binding = 0) uniform sampler2D GBufferHiAlbedo;
-layout(set = 2, binding = 1) uniform sampler2D GBufferHiEmission;
-layout(set = 2, binding = 2) uniform sampler2D GBufferHiSpecular;
-layout(set = 2, binding = 3) uniform sampler2D GBufferHiTransmittance;
-layout(set = 2, binding = 4) uniform sampler2D GBufferHiNormal;
-layout(set = 2, binding = 5) uniform sampler2D GBufferHiLODMask;
-layout(set = 2, binding = 6) uniform sampler2D GBufferHiDepth;
+layout(location = 0) in vec2 ScreenUV;
 
 layout(location = 0) out vec4 FragAlbedo;
 layout(location = 1) out vec4 FragEmission;
@@ -33,69 +19,22 @@ layout(location = 2) out vec4 FragSpecular;
 layout(location = 3) out vec4 FragTransmittance;
 layout(location = 4) out vec4 FragNormal;
 layout(location = 5) out float FragDepth;
+layout(location = 6) out vec2 FragVelocity;
 
-layout(push_constant) uniform IMAGE_INFO { vec2 resolution; };
+layout(push_constant) uniform IMAGE_INFO { vec2 resolution; uint frameIndex; };
 
 void main()
 {
-	uint rng = uint(texture(RNGSource, ScreenUV).r);
+	// Same seed as the direct illumination pass, so both select the same LOD for this pixel
+	uint rng = initPixelSeed(uvec2(gl_FragCoord.xy), frameIndex, RNG_SALT_HYBRID_LOD);
 	uint rayMask = generateRayMask(rng);
 
-	uint LODLoDefMask = uint(texture(GBufferLoLODMask, ScreenUV).r);
-	uint LODHiDefMask = uint(texture(GBufferHiLODMask, ScreenUV).r);
-	float LODLoDefDepth = texture(GBufferLoDepth, ScreenUV).r;
-	float LODHiDefDepth = texture(GBufferHiDepth, ScreenUV).r;
-
-	// Set default values
-	FragAlbedo = vec4(0);
-	FragEmission = vec4(0);
-	FragSpecular = vec4(0);
-	FragTransmittance = vec4(0);
-	FragNormal = vec4(0);
-	FragDepth = 1.0;
-
-	// Check based on depth which level should be sampled first
-	bool sampleLoFirst = LODLoDefDepth < LODHiDefDepth;
-	if (sampleLoFirst)
-	{
-		if ((LODLoDefMask & rayMask) != 0)
-		{
-			FragAlbedo = texture(GBufferLoAlbedo, ScreenUV);
-			FragEmission = texture(GBufferLoEmission, ScreenUV);
-			FragSpecular = texture(GBufferLoSpecular, ScreenUV);
-			FragTransmittance = texture(GBufferLoTransmittance, ScreenUV);
-			FragNormal = texture(GBufferLoNormal, ScreenUV);
-			FragDepth = LODLoDefDepth;
-		}
-		else
-		{
-			FragAlbedo = texture(GBufferHiAlbedo, ScreenUV);
-			FragEmission = texture(GBufferHiEmission, ScreenUV);
-			FragSpecular = texture(GBufferHiSpecular, ScreenUV);
-			FragTransmittance = texture(GBufferHiTransmittance, ScreenUV);
-			FragNormal = texture(GBufferHiNormal, ScreenUV);
-			FragDepth = LODHiDefDepth;
-		}
-	}
-	else	// sample hi first
-	{
-		if ((LODHiDefMask & rayMask) != 0)
-		{
-			FragAlbedo = texture(GBufferHiAlbedo, ScreenUV);
-			FragEmission = texture(GBufferHiEmission, ScreenUV);
-			FragSpecular = texture(GBufferHiSpecular, ScreenUV);
-			FragTransmittance = texture(GBufferHiTransmittance, ScreenUV);
-			FragNormal = texture(GBufferHiNormal, ScreenUV);
-			FragDepth = LODHiDefDepth;
-		}
-		else
-		{
-			FragAlbedo = texture(GBufferLoAlbedo, ScreenUV);
-			FragEmission = texture(GBufferLoEmission, ScreenUV);
-			FragSpecular = texture(GBufferLoSpecular, ScreenUV);
-			FragTransmittance = texture(GBufferLoTransmittance, ScreenUV);
-			FragNormal = texture(GBufferLoNormal, ScreenUV);
-			FragDepth = LODLoDefDepth;
-		}
-	}
+	GBufferSample gbufferSample = sampleGBufferLODs(ScreenUV, rayMask);
+	FragAlbedo = gbufferSample.albedo;
+	FragEmission = gbufferSample.emission;
+	FragSpecular = gbufferSample.specular;
+	FragTransmittance = gbufferSample.transmittance;
+	FragNormal = gbufferSample.normal;
+	FragDepth = gbufferSample.depth;
+	FragVelocity = gbufferSample.velocity;
 }
\ No newline at end of file
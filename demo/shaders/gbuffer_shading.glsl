@@ -0,0 +1,61 @@
+#ifndef GBUFFER_SHADING_GLSL
+#define GBUFFER_SHADING_GLSL
+
+/// Fused G-buffer sampling & deferred shading, selects a LOD layout per pixel & shades it with the direct illumination result.
+/// Includers define GBUFFER_SHADING_TILED_LIGHTS, if set the tiled light lists are evaluated instead of the direct illumination result.
+
+#extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+
+#include "shader_common.glsl"
+#include "raytracing_common.glsl"
+
+#define GBUFFER_LOD_LO_SET	0
+#define GBUFFER_LOD_HI_SET	1
+#include "gbuffer_lod_sampling.glsl"
+
+#if GBUFFER_SHADING_TILED_LIGHTS == 1
+#define LIGHT_LIST_SET		3
+#include "light_culling.glsl"
+#endif
+
+// Must match DEMO_GBUFFER_SHADING_GROUP_SIZE
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(set = 2, binding = 0) uniform sampler2D DirectIllumination;
+layout(set = 2, binding = 1, rgba32f) uniform writeonly image2D renderResult;
+layout(set = 2, binding = 2, rgba16f) uniform writeonly image2D renderNormal;
+layout(set = 2, binding = 3, r32f) uniform writeonly image2D renderDepth;
+layout(set = 2, binding = 4, rg16f) uniform writeonly image2D renderVelocity;
+
+layout(push_constant) uniform IMAGE_INFO { vec2 resolution; uint frameIndex; };
+
+void main()
+{
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(vec2(texel), resolution)))
+		return;
+
+	vec2 uv = (vec2(texel) + vec2(0.5)) / resolution;
+
+	// Same seed as the direct illumination pass, so both select the same LOD for this pixel
+	uint rng = initPixelSeed(uvec2(texel), frameIndex, RNG_SALT_HYBRID_LOD);
+	uint rayMask = generateRayMask(rng);
+
+	GBufferSample gbufferSample = sampleGBufferLODs(uv, rayMask);
+#if GBUFFER_SHADING_TILED_LIGHTS == 1
+	// Analytic lighting from the lights culled into this pixel's tile replaces the traced direct illumination
+	HybridInitialHit hit = getInitialHitData(lightingCamera.invView, lightingCamera.invProject, uv, gbufferSample.normal.xyz, gbufferSample.depth);
+	vec3 DI = hit.miss ? vec3(0) : evaluateTiledLights(texel, hit.worldPos, hit.worldNormal);
+#else
+	vec3 DI = texelFetch(DirectIllumination, texel, 0).rgb;	// Over-allocated, so fetched by pixel
+#endif
+	vec3 outColor = resolveHybridShading(gbufferSample.albedo.rgb, gbufferSample.emission.rgb, gbufferSample.depth, DI);
+
+	// Normal, depth & velocity are still written for temporal reprojection
+	imageStore(renderResult, texel, vec4(outColor, 1));
+	imageStore(renderNormal, texel, gbufferSample.normal);
+	imageStore(renderDepth, texel, vec4(gbufferSample.depth));
+	imageStore(renderVelocity, texel, vec4(gbufferSample.velocity, 0, 0));
+}
+
+#endif
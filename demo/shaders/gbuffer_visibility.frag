@@ -0,0 +1,22 @@
+#version 450
+
+/// Visibility buffer output, G-buffer targets are reconstructed from it in gbuffer_resolve.comp
+
+layout(location = 0) in VS_OUT
+{
+    vec4 wPos;
+    vec3 normal;
+    vec2 texCoord;
+    flat uint instanceId;
+    flat uint lodMask;
+    flat uint drawInstanceIdx;
+    vec4 clipPos;
+    vec4 prevClipPos;
+} fs_in;
+
+layout(location = 0) out uvec2 FragVisibility;
+
+void main()
+{
+    FragVisibility = uvec2(fs_in.drawInstanceIdx, uint(gl_PrimitiveID));
+}
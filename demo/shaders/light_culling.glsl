@@ -0,0 +1,56 @@
+#ifndef LIGHT_CULLING_GLSL
+#define LIGHT_CULLING_GLSL
+
+/// Tiled light lists, shared by the light culling pass & the shading passes that evaluate culled lights.
+/// Shading passes define LIGHT_LIST_SET, the set binds the camera, the scene light array & the culled tile light lists.
+
+#include "shader_common.glsl"
+
+// Must match DEMO_LIGHT_TILE_SIZE & DEMO_LIGHT_TILE_STRIDE
+#define LIGHT_TILE_SIZE			16
+#define MAX_LIGHTS_PER_TILE		63
+#define LIGHT_TILE_STRIDE		(MAX_LIGHTS_PER_TILE + 1)	// Light count followed by light indices
+
+/// @brief Get the offset of a tile's light list in the tile light buffer.
+uint tileLightListOffset(ivec2 pixel, uint tileCountX)
+{
+	uvec2 tile = uvec2(pixel) / LIGHT_TILE_SIZE;
+	return (tile.y * tileCountX + tile.x) * LIGHT_TILE_STRIDE;
+}
+
+/// @brief Evaluate the reflected radiance of a diffuse white surface lit by a sphere light, without visibility.
+///		For small solid angles the irradiance is Le * pi * (r / d)^2 * cos, the lambertian BRDF divides out pi.
+vec3 evaluateSphereLight(LightArrayEntry light, vec3 P, vec3 N)
+{
+	vec3 toLight = light.positionRadius.xyz - P;
+	float radius = light.positionRadius.w;
+	float distSq = dot(toLight, toLight);
+	float cosTheta = max(dot(N, toLight * inversesqrt(max(distSq, 1e-8))), 0.0);
+
+	// Window the falloff so the contribution reaches zero at the culling range
+	float rangeFactor = clamp(1.0 - pow(distSq / (light.emissionRange.w * light.emissionRange.w), 2.0), 0.0, 1.0);
+	return light.emissionRange.rgb * (radius * radius / max(distSq, radius * radius)) * cosTheta * rangeFactor * rangeFactor;
+}
+
+#ifdef LIGHT_LIST_SET
+layout(set = LIGHT_LIST_SET, binding = 0) uniform LIGHTING_CAMERA { Camera lightingCamera; };
+layout(set = LIGHT_LIST_SET, binding = 1) readonly buffer LIGHT_ARRAY { LightArrayEntry lights[]; };
+layout(set = LIGHT_LIST_SET, binding = 2) readonly buffer TILE_LIGHT_LISTS { uvec4 tileInfo; uint tileLightLists[]; };
+
+/// @brief Evaluate all lights culled into a pixel's tile, the result still has to be multiplied with the surface albedo.
+vec3 evaluateTiledLights(ivec2 pixel, vec3 P, vec3 N)
+{
+	uint listOffset = tileLightListOffset(pixel, tileInfo.x);
+	uint lightCount = tileLightLists[listOffset];
+
+	vec3 radiance = vec3(0);
+	for (uint i = 0; i < lightCount; i++)
+	{
+		radiance += evaluateSphereLight(lights[tileLightLists[listOffset + 1 + i]], P, N);
+	}
+
+	return radiance;
+}
+#endif
+
+#endif
@@ -1,12 +1,22 @@
 #version 450
 
+#extension GL_EXT_nonuniform_qualifier : require
+
+#include "bindless.glsl"
+
 layout(location = 0) in vec2 ScreenUV;
 
 layout(location = 0) out vec4 FragColor;
 
-layout(binding = 0) uniform sampler2D RenderResult;
+layout(push_constant) uniform PRESENT_INPUT
+{
+	uint renderResultIndex;
+};
+
+#define RenderResult	BindlessSampledImages[renderResultIndex]
 
 void main()
 {
-	FragColor = texture(RenderResult, ScreenUV);
+	// The reprojected result is over-allocated, so it is fetched by pixel
+	FragColor = texelFetch(RenderResult, ivec2(gl_FragCoord.xy), 0);
 }
\ No newline at end of file
@@ -19,6 +19,29 @@ uint initSeed(uint seed)
 	return WangHash((seed + 1) * 0x11);
 }
 
+/// --- Stateless per pixel seeding
+
+// Salts separate the random streams of different dispatches for the same pixel & frame.
+// Passes that must make identical random choices for a pixel (e.g. stochastic LOD selection) share a salt.
+#define RNG_SALT_PATH_TRACER	0x5A17u
+#define RNG_SALT_HYBRID_LOD		0x10D5u
+
+// PCG hash, based on https://www.reedbeta.com/blog/hash-functions-for-gpu-rendering/
+uint PCGHash(uint seed)
+{
+	uint state = seed * 747796405u + 2891336453u;
+	uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+	return (word >> 22u) ^ word;
+}
+
+uint initPixelSeed(uvec2 pixel, uint frameIndex, uint salt)
+{
+	uint seed = PCGHash(pixel.x + PCGHash(pixel.y + PCGHash(frameIndex + PCGHash(salt))));
+
+	// Xorshift state must be nonzero
+	return seed == 0 ? 1 : seed;
+}
+
 uint randomUint(inout uint seed)
 {
 	seed ^= seed << 13;
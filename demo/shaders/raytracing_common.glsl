@@ -1,7 +1,6 @@
 #ifndef RT_COMMON_GLSL
 #define RT_COMMON_GLSL
 
-#define RAYTRACE_MAX_BOUNCE_COUNT	5
 #define RAYTRACE_RANGE_TMIN			1e-2
 #define RAYTRACE_RANGE_TMAX			1e30
 #define RAYTRACE_MASK_BITS			8
@@ -31,15 +30,16 @@ struct HybridInitialHit
 	vec3 Wi;
 };
 
+/// Path tracing hit data, the bounce loop runs in the ray generation shader
 struct PTRayPayload
 {
-	uint seed;
-	uint traceDepth;
-	uint rayMask;
+	bool miss;
+	uint materialIdx;
+	uint renderInstanceIdx;	// Scene node of the hit, used to find the light sampling PDF of emitters
+	float areaPDF;			// Area density of uniformly sampling the hit point on its mesh
 	vec3 hitPos;
 	vec3 hitNormal;
-	vec3 energy;
-	vec3 transmission;
+	vec3 hitTangent;
 };
 
 struct DIRayPayload
@@ -64,14 +64,12 @@ bool gbufferRayHit(float depth)
 	return depth < 1.0;
 }
 
-HybridInitialHit getInitialHitData(mat4 inverseView, mat4 inverseProject, vec2 inUV, sampler2D GBufferNormal, sampler2D GBufferDepth)
+HybridInitialHit getInitialHitData(mat4 inverseView, mat4 inverseProject, vec2 inUV, vec3 gbufferNormal, float initialHitDepth)
 {
 	vec2 ndc = 2.0 * inUV - 1.0;
-
-	float initialHitDepth = float(texture(GBufferDepth, inUV));
 	vec3 wPos = depthToWorldPos(inverseProject, inverseView, ndc, initialHitDepth);
 
-	vec3 wNormal = vec3(texture(GBufferNormal, inUV));
+	vec3 wNormal = gbufferNormal;
 	vec3 Wi = vec3(inverseView * vec4(normalize((inverseProject * vec4(ndc, 1, 1)).xyz), 0));
 
 	wNormal = normalize(wNormal);
@@ -86,6 +84,11 @@ HybridInitialHit getInitialHitData(mat4 inverseView, mat4 inverseProject, vec2 i
 	return hit;
 }
 
+HybridInitialHit getInitialHitData(mat4 inverseView, mat4 inverseProject, vec2 inUV, sampler2D GBufferNormal, sampler2D GBufferDepth)
+{
+	return getInitialHitData(inverseView, inverseProject, inUV, vec3(texture(GBufferNormal, inUV)), float(texture(GBufferDepth, inUV)));
+}
+
 Material getMaterialFromGBuffer(
 	vec2 inUV,
 	sampler2D GBufferAlbedo,
@@ -110,28 +113,47 @@ Material getMaterialFromGBuffer(
 
 /// --- Random walk functions
 
-vec3 diffuseReflect(inout uint seed, vec3 wI, vec3 N)
+/// @brief Build a tangent space basis around N, T is orthogonalized against N if usable.
+///		Without a usable tangent the basis of Duff et al. 2017 ("Building an Orthonormal Basis, Revisited") is used.
+mat3 orthonormalBasis(vec3 N, vec3 T)
 {
-	vec3 outDir = vec3(0);
-	do
+	vec3 tangent = T - N * dot(N, T);
+	if (dot(tangent, tangent) > 1e-8)
+	{
+		tangent = normalize(tangent);
+	}
+	else
 	{
-		outDir = vec3(
-			randomRange(seed, -1.0, 1.0),
-			randomRange(seed, -1.0, 1.0),
-			randomRange(seed, -1.0, 1.0)
-		);
-	} while(dot(outDir, outDir) > 1.0);
+		float s = (N.z >= 0.0) ? 1.0 : -1.0;
+		float a = -1.0 / (s + N.z);
+		tangent = vec3(1.0 + s * N.x * N.x * a, s * N.x * N.y * a, -s * N.x);
+	}
+
+	return mat3(tangent, cross(N, tangent), N);
+}
+
+/// @brief Cosine weighted hemisphere sample around N, uses exactly 2 random numbers.
+vec3 diffuseReflect(inout uint seed, vec3 wI, vec3 N, vec3 T)
+{
+	float r1 = randomFloat(seed);
+	float r2 = randomFloat(seed);
 
-	if (dot(outDir, N) < 0.0)
-		outDir *= -1.0;
+	float r = sqrt(r1);
+	float phi = RT_2PI * r2;
+	vec3 localDir = vec3(r * cos(phi), r * sin(phi), sqrt(max(0.0, 1.0 - r1)));
 
-	return normalize(outDir);
+	return normalize(orthonormalBasis(N, T) * localDir);
 }
 
-void randomWalk(inout uint seed, vec3 Wi, vec3 N, Material material, out vec3 Wo, out bool specularEvent)
+void randomWalk(inout uint seed, vec3 Wi, vec3 N, vec3 T, Material material, out vec3 Wo, out bool specularEvent)
 {
 	specularEvent = false;
-	Wo = diffuseReflect(seed, Wi, N);
+	Wo = diffuseReflect(seed, Wi, N, T);
+}
+
+void randomWalk(inout uint seed, vec3 Wi, vec3 N, Material material, out vec3 Wo, out bool specularEvent)
+{
+	randomWalk(seed, Wi, N, vec3(0), material, Wo, specularEvent);
 }
 
 /// --- Material evaluation functions
@@ -141,12 +163,46 @@ float luminance(vec3 color)
 	return color.r + color.g + color.b;
 }
 
+/// @brief Resolve the final hybrid shading for a pixel from its G-buffer data & resolved direct illumination.
+vec3 resolveHybridShading(vec3 albedo, vec3 emission, float depth, vec3 DI)
+{
+	if (luminance(emission) > 0.0)
+	{	// Hit light -> overlay light on shading pass
+		return emission;
+	}
+	else if (!gbufferRayHit(depth))
+	{	// Missed scene entirely -> draw sky
+		return SKY_COLOR;
+	}
+
+	// Hit something, resolve Direct Illumination
+	return albedo * DI;
+}
+
+/// @brief Cosine term divided by the sampling PDF of Wo, cosine weighted sampling cancels down to pi.
 float evaluatePDF(vec3 Wo, vec3 N, Material material, bool specularEvent)
 {
 	if (specularEvent)
 		return 1.0;
 
-	return dot(Wo, N) * RT_2PI;
+	return RT_PI;
+}
+
+/// @brief Solid angle density with which randomWalk samples Wo, used for multiple importance sampling.
+float evaluateSamplingPDF(vec3 Wo, vec3 N, Material material, bool specularEvent)
+{
+	if (specularEvent)
+		return 0.0;
+
+	return max(dot(Wo, N), 0.0) * RT_INV_PI;
+}
+
+/// @brief Power heuristic (beta = 2) weight for a sample taken with PDF pdfA, combined with a strategy of PDF pdfB.
+float powerHeuristic(float pdfA, float pdfB)
+{
+	float a2 = pdfA * pdfA;
+	float b2 = pdfB * pdfB;
+	return (a2 + b2) > 0.0 ? a2 / (a2 + b2) : 0.0;
 }
 
 vec3 evaluateBRDF(vec3 Wi, vec3 Wo, vec3 N, Material material, bool specularEvent)
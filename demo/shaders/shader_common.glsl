@@ -6,12 +6,16 @@
 /// Shared include file for shader definitions
 
 #define INSTANCE_MASK_BITS 8
+#define VALID_MASK ((1 << INSTANCE_MASK_BITS) - 1)
 
+// Per draw instance info, indexed using gl_InstanceIndex
 struct InstanceInfo
 {
 	uint instanceId;
 	uint lodMask;
+	uint layer;
 	mat4 model;
+	mat4 prevModel;
 };
 
 // Mirrors render instance data from scene.h
@@ -19,13 +23,25 @@ struct RenderInstanceData
 {
 	uint materialIdx;
 	uint indexCount;
+	uint firstIndex;
+	int vertexOffset;
 	uint64_t vertexBufferAddress;
 	uint64_t indexBufferAddress;
+	vec4 boundingSphere;
 };
 
-struct LighArrayEntry
+// Mirrors light array entries from scene.h
+struct LightArrayEntry
 {
+	vec4 positionRadius;
+	vec4 emissionRange;
+	mat4 transform;
 	uint lightIdx;
+	uint instanceIdLOD0;
+	uint instanceIdLOD1;
+	uint lodMask;
+	float selectionPdf;
+	float selectionCdf;
 };
 
 // Mirrors material data from material.h
@@ -55,10 +71,20 @@ struct Camera
 	vec3 forward;
 	vec3 right;
 	vec3 up;
-    mat4 view;
-    mat4 project;
+	mat4 view;
+	mat4 project;
+	mat4 invView;
+	mat4 invProject;
+	mat4 viewProject;
+	mat4 prevViewProject;
 };
 
+// Screen space (UV) motion from the previous to the current clip space position
+vec2 screenVelocity(vec4 clipPos, vec4 prevClipPos)
+{
+	return 0.5 * (clipPos.xy / clipPos.w - prevClipPos.xy / prevClipPos.w);
+}
+
 vec3 depthToWorldPos(mat4 invProject, mat4 invView, vec2 ndc, float depth)
 {
 	vec4 clip = invProject * vec4(ndc, depth, 1);
@@ -1,6 +1,7 @@
 #version 450
 
 #extension GL_EXT_shader_explicit_arithmetic_types_int64 : require
+#extension GL_ARB_shader_viewport_layer_array : require
 
 #include "shader_common.glsl"
 
@@ -14,6 +15,11 @@ layout(location = 0) out VS_OUT
     vec4 wPos;
     vec3 normal;
     vec2 texCoord;
+    flat uint instanceId;
+    flat uint lodMask;
+    flat uint drawInstanceIdx;
+    vec4 clipPos;
+    vec4 prevClipPos;
 } vs_out;
 
 layout(set = 0, binding = 0) uniform CAMERA
@@ -21,18 +27,27 @@ layout(set = 0, binding = 0) uniform CAMERA
     Camera camera;
 };
 
-layout(push_constant) uniform INSTANCE_INFO
-{
-    InstanceInfo instanceInfo;
-};
+layout(set = 0, binding = 3) readonly buffer DRAW_INSTANCE_DATA { InstanceInfo drawInstances[]; };
+
+// Must match depth_prepass.vert for EQUAL depth testing against the depth prepass
+invariant gl_Position;
 
 void main()
 {
+    InstanceInfo instanceInfo = drawInstances[gl_InstanceIndex];
     vec4 wPos = instanceInfo.model * vec4(VertexPosition, 1);
 
     vs_out.wPos = wPos;
     vs_out.normal = normalize(instanceInfo.model * vec4(VertexNormal, 0)).xyz;
     vs_out.texCoord = VertexTexCoord;
+    vs_out.instanceId = instanceInfo.instanceId;
+    vs_out.lodMask = instanceInfo.lodMask;
+    vs_out.drawInstanceIdx = uint(gl_InstanceIndex);
+
+    gl_Position = camera.viewProject * vs_out.wPos;
 
-    gl_Position = camera.project * camera.view * vs_out.wPos;
+    // Clip positions for motion vectors, interpolated & divided per fragment
+    vs_out.clipPos = gl_Position;
+    vs_out.prevClipPos = camera.prevViewProject * (instanceInfo.prevModel * vec4(VertexPosition, 1));
+    gl_Layer = int(instanceInfo.layer);
 }
@@ -119,8 +119,37 @@ RayTracingPipelineBuilder& RayTracingPipelineBuilder::setCreateFlags(VkPipelineC
 	return *this;
 }
 
+RayTracingPipelineBuilder& RayTracingPipelineBuilder::setLibraryInterface(uint32_t maxPayloadSize, uint32_t maxHitAttributeSize)
+{
+	m_useLibraryInterface = true;
+	m_libraryInterface.maxPipelineRayPayloadSize = maxPayloadSize;
+	m_libraryInterface.maxPipelineRayHitAttributeSize = maxHitAttributeSize;
+
+	return *this;
+}
+
+RayTracingPipelineBuilder& RayTracingPipelineBuilder::addLibrary(const RayTracingPipelineLibrary& library)
+{
+	assert(library.pipeline != VK_NULL_HANDLE);
+	m_libraries.push_back(library);
+
+	return *this;
+}
+
 VkPipeline RayTracingPipelineBuilder::build(VkPipelineCache cache, VkDeferredOperationKHR deferredOperation)
 {
+	// Linking libraries requires a library interface
+	assert(m_libraries.empty() || m_useLibraryInterface);
+
+	std::vector<VkPipeline> libraryHandles = {};
+	libraryHandles.reserve(m_libraries.size());
+	for (auto const& library : m_libraries)
+		libraryHandles.push_back(library.pipeline);
+
+	VkPipelineLibraryCreateInfoKHR libraryInfo = VkPipelineLibraryCreateInfoKHR{ VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR };
+	libraryInfo.libraryCount = static_cast<uint32_t>(libraryHandles.size());
+	libraryInfo.pLibraries = libraryHandles.data();
+
 	VkPipelineDynamicStateCreateInfo dynamicState = VkPipelineDynamicStateCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
 	dynamicState.dynamicStateCount = static_cast<uint32>(m_dynamicStates.size());
 	dynamicState.pDynamicStates = m_dynamicStates.data();
@@ -132,6 +161,8 @@ VkPipeline RayTracingPipelineBuilder::build(VkPipelineCache cache, VkDeferredOpe
 	pipelineCreateInfo.groupCount = static_cast<uint32_t>(m_shaderGroups.size());
 	pipelineCreateInfo.pGroups = m_shaderGroups.data();
 	pipelineCreateInfo.maxPipelineRayRecursionDepth = m_maxRecursionDepth;
+	pipelineCreateInfo.pLibraryInfo = libraryHandles.empty() ? nullptr : &libraryInfo;
+	pipelineCreateInfo.pLibraryInterface = m_useLibraryInterface ? &m_libraryInterface : nullptr;
 	pipelineCreateInfo.pDynamicState = &dynamicState;
 	pipelineCreateInfo.layout = m_layout;
 	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
@@ -151,6 +182,32 @@ VkPipeline RayTracingPipelineBuilder::build(VkPipelineCache cache, VkDeferredOpe
 	return pipeline;
 }
 
+RayTracingPipelineLibrary RayTracingPipelineBuilder::buildLibrary(VkPipelineCache cache)
+{
+	// Library interface is required for pipeline libraries
+	assert(m_useLibraryInterface);
+
+	VkPipelineCreateFlags flags = m_flags;
+	m_flags |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR;
+
+	RayTracingPipelineLibrary library = RayTracingPipelineLibrary{};
+	library.pipeline = build(cache);
+	library.shaderStages = m_shaderStages;
+	library.shaderGroups = m_shaderGroups;
+
+	m_flags = flags;
+	return library;
+}
+
+uint32_t RayTracingPipelineBuilder::groupCount() const
+{
+	size_t count = m_shaderGroups.size();
+	for (auto const& library : m_libraries)
+		count += library.shaderGroups.size();
+
+	return static_cast<uint32_t>(count);
+}
+
 ShaderBindingTable::ShaderBindingTable(
 	RayTracingContext& ctx,
 	VkPipeline pipeline,
@@ -161,7 +218,7 @@ ShaderBindingTable::ShaderBindingTable(
 	m_handleInfo(getShaderGroupHandleInfo(ctx))
 {
 	// Populate shader group count, indices & stride
-	const uint32_t groupCount = static_cast<uint32_t>(pipelineBuilder.shaderGroups().size());
+	const uint32_t groupCount = pipelineBuilder.groupCount();
 	getShaderGroupIndices(pipelineBuilder);
 	getShaderGroupStrides();
 
@@ -246,15 +303,31 @@ const VkStridedDeviceAddressRegionKHR ShaderBindingTable::getRegion(SBTShaderGro
 
 void ShaderBindingTable::getShaderGroupIndices(const RayTracingPipelineBuilder& pipelineBuilder)
 {
-	auto const& shaderStages = pipelineBuilder.shaderStages();
-	auto const& shaderGroups = pipelineBuilder.shaderGroups();
-
 	for (auto& indices : m_shaderGroupIndices)
 		indices = {};
 
-	for (uint32_t groupIdx = 0; groupIdx < shaderGroups.size(); groupIdx++)
+	// Library shader groups are appended after the pipeline's own groups, in link order
+	uint32_t groupOffset = 0;
+	appendShaderGroupIndices(pipelineBuilder.shaderStages(), pipelineBuilder.shaderGroups(), groupOffset);
+	groupOffset += static_cast<uint32_t>(pipelineBuilder.shaderGroups().size());
+
+	for (auto const& library : pipelineBuilder.libraries())
+	{
+		appendShaderGroupIndices(library.shaderStages, library.shaderGroups, groupOffset);
+		groupOffset += static_cast<uint32_t>(library.shaderGroups.size());
+	}
+}
+
+void ShaderBindingTable::appendShaderGroupIndices(
+	const std::vector<VkPipelineShaderStageCreateInfo>& shaderStages,
+	const std::vector<VkRayTracingShaderGroupCreateInfoKHR>& shaderGroups,
+	uint32_t groupOffset
+)
+{
+	for (uint32_t localGroupIdx = 0; localGroupIdx < shaderGroups.size(); localGroupIdx++)
 	{
-		auto const& rtShaderGroup = shaderGroups[groupIdx];
+		auto const& rtShaderGroup = shaderGroups[localGroupIdx];
+		const uint32_t groupIdx = groupOffset + localGroupIdx;
 
 		if (rtShaderGroup.type == VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR)
 		{
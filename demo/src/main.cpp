@@ -187,6 +187,14 @@ bool drawConfigWindow(float deltaTime, Renderer& renderer, hri::Camera& camera,
 		updated |= ImGui::Checkbox("Use reference Path Tracer", &renderer.usePathTracer);
 		updated |= ImGui::Checkbox("Use temporal accumulation", &renderer.useTemporalAccumulation);
 
+		const uint32_t minBounceCount = 0, maxBounceCount = DEMO_MAX_PT_BOUNCE_COUNT;
+		updated |= ImGui::SliderScalar("Path Tracer Bounces", ImGuiDataType_U32, &renderer.pathTracerBounceCount, &minBounceCount, &maxBounceCount);
+		updated |= ImGui::SliderScalar("Roulette After Bounce", ImGuiDataType_U32, &renderer.pathTracerRouletteBounceCount, &minBounceCount, &maxBounceCount);
+
+		const uint32_t minSamplesPerPixel = 1, maxSamplesPerPixel = DEMO_MAX_PT_SAMPLES_PER_PIXEL;
+		updated |= ImGui::SliderScalar("Path Tracer SPP", ImGuiDataType_U32, &renderer.pathTracerSamplesPerPixel, &minSamplesPerPixel, &maxSamplesPerPixel);
+		updated |= ImGui::Checkbox("Use progressive accumulation", &renderer.useProgressiveAccumulation);
+
 		ImGui::SeparatorText("Scene");
 		updated |= ImGui::DragFloat("LOD Bias", &scene.parameters.lodBias, 0.01f);
 		updated |= ImGui::DragFloat("LOD T Interval", &scene.parameters.transitionInterval, 0.01f, 0.0f, 1.0f);
@@ -285,6 +293,8 @@ int main()
    		VK_KHR_ACCELERATION_STRUCTURE_EXTENSION_NAME,
    		VK_KHR_RAY_TRACING_PIPELINE_EXTENSION_NAME,
    		VK_KHR_RAY_QUERY_EXTENSION_NAME,
+   		VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+   		VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME,
 	};
 
 	// Enable required features
@@ -297,16 +307,36 @@ int main()
 	VkPhysicalDeviceRayTracingPipelineFeaturesKHR rtPipelineFeatures = VkPhysicalDeviceRayTracingPipelineFeaturesKHR{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_FEATURES_KHR };
 	rtPipelineFeatures.rayTracingPipeline = true;
 
+	VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures = VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT{ VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT };
+	graphicsPipelineLibraryFeatures.graphicsPipelineLibrary = true;
+
 	ctxCreateInfo.deviceFeatures.shaderInt64 = true;
+	ctxCreateInfo.deviceFeatures.multiDrawIndirect = true;
+	ctxCreateInfo.deviceFeatures.drawIndirectFirstInstance = true;
+	ctxCreateInfo.deviceFeatures.geometryShader = DEMO_VISIBILITY_BUFFER_GBUFFER == 1;						// Required for gl_PrimitiveID in the visibility buffer fragment shader
+	ctxCreateInfo.deviceFeatures.shaderStorageImageWriteWithoutFormat = DEMO_VISIBILITY_BUFFER_GBUFFER == 1;	// Required for the untyped target writes in the visibility buffer resolve
 	ctxCreateInfo.deviceFeatures12.hostQueryReset = true;
+	ctxCreateInfo.deviceFeatures12.drawIndirectCount = true;
 	ctxCreateInfo.deviceFeatures12.bufferDeviceAddress = true;
 	ctxCreateInfo.deviceFeatures12.descriptorIndexing = true;
+	ctxCreateInfo.deviceFeatures12.runtimeDescriptorArray = true;
+	ctxCreateInfo.deviceFeatures12.descriptorBindingPartiallyBound = true;
+	ctxCreateInfo.deviceFeatures12.descriptorBindingUpdateUnusedWhilePending = true;
+	ctxCreateInfo.deviceFeatures12.descriptorBindingSampledImageUpdateAfterBind = true;
+	ctxCreateInfo.deviceFeatures12.descriptorBindingStorageImageUpdateAfterBind = true;
+	ctxCreateInfo.deviceFeatures12.descriptorBindingStorageBufferUpdateAfterBind = true;
+	ctxCreateInfo.deviceFeatures12.shaderSampledImageArrayNonUniformIndexing = true;
+	ctxCreateInfo.deviceFeatures12.shaderStorageImageArrayNonUniformIndexing = true;
+	ctxCreateInfo.deviceFeatures12.shaderStorageBufferArrayNonUniformIndexing = true;
 	ctxCreateInfo.deviceFeatures12.scalarBlockLayout = true;
+	ctxCreateInfo.deviceFeatures12.shaderOutputLayer = true;
 	ctxCreateInfo.deviceFeatures13.synchronization2 = true;
+	ctxCreateInfo.deviceFeatures13.dynamicRendering = true;
 	ctxCreateInfo.extensionFeatures = {
 		rayQueryFeatures,
 		accelerationStructureFeatures,
 		rtPipelineFeatures,
+		graphicsPipelineLibraryFeatures,
 	};
 
 	hri::RenderContext renderContext = hri::RenderContext(ctxCreateInfo);
@@ -341,6 +371,15 @@ int main()
 	uint32_t frameIndex = 0;
 #endif
 
+#if DO_TILE_SIZE_BENCHMARK == 1
+	uint32_t tileSizeIndex = 0;
+	uint32_t tileFrameIndex = 0;
+	Renderer::ComputePassTimings tileTimings = Renderer::ComputePassTimings{};
+	renderer.computeTileSize = gComputeTileSizes[tileSizeIndex];
+
+	printf("Running tile size benchmark (%d frames per tile size)\n", TILE_SIZE_BENCHMARK_FRAME_COUNT);
+#endif
+
 	while (!windowManager.windowShouldClose(gWindow))
 	{
 #if DO_BENCHMARK == 1
@@ -372,6 +411,10 @@ int main()
 		bool UIUpdated = drawConfigWindow(gFrameTimer.deltaTime, renderer, camera, scene);
 		uiManager.endDraw();
 
+		// Camera & instance motion is detected by the renderer, other setting changes also invalidate accumulated samples
+		if (UIUpdated)
+			renderer.resetAccumulation();
+
 		// Update scene & draw renderer frame
 		scene.update(gFrameTimer.deltaTime);
 		renderer.prepareFrame();
@@ -394,6 +437,29 @@ int main()
 #if DO_BENCHMARK == 1
 		frameIndex++;
 #endif
+
+#if DO_TILE_SIZE_BENCHMARK == 1
+		Renderer::ComputePassTimings frameTimings = renderer.getComputePassTimings();
+		tileTimings.temporalReproject += frameTimings.temporalReproject;
+		tileFrameIndex++;
+
+		if (tileFrameIndex == TILE_SIZE_BENCHMARK_FRAME_COUNT)
+		{
+			printf(
+				"Tile %2ux%-2u: Reproject %8.4f ms (avg)\n",
+				renderer.computeTileSize, renderer.computeTileSize,
+				tileTimings.temporalReproject / static_cast<float>(TILE_SIZE_BENCHMARK_FRAME_COUNT)
+			);
+
+			tileSizeIndex++;
+			if (tileSizeIndex >= HRI_SIZEOF_ARRAY(gComputeTileSizes))
+				break;
+
+			tileFrameIndex = 0;
+			tileTimings = Renderer::ComputePassTimings{};
+			renderer.computeTileSize = gComputeTileSizes[tileSizeIndex];
+		}
+#endif
 	}
 
 	printf("Shutting down\n");
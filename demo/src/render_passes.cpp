@@ -3,146 +3,161 @@
 #include <hybrid_renderer.h>
 #include <imgui_impl_vulkan.h>
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 #include "detail/raytracing.h"
 #include "scene.h"
 
-// --- IRenderPass ---
-
-IRenderPass::IRenderPass(hri::RenderContext& ctx)
-	:
-	context(ctx)
-{
-	//
-}
-
-void IRenderPass::prepareFrame(CommonResources& resources)
-{
-	// Don't do anything by default
-}
-
-// --- RNG Generation Pass ---
-
-RngGenerationPass::RngGenerationPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator)
-	:
-	IRenderPass(ctx)
+// --- Tiled compute helpers ---
+
+/// @brief Create a compute pipeline for each supported tile size, specializing the workgroup size.
+/// @param shaderDB Shader database to use.
+/// @param name Base pipeline name, tile size is appended for each variant.
+/// @param computeShader Compute shader name.
+/// @param layout Pipeline layout to use.
+/// @return A map of tile size to pipeline.
+static std::unordered_map<uint32_t, hri::PipelineStateObject*> createTiledComputePipelines(
+	hri::ShaderDatabase& shaderDB,
+	const std::string& name,
+	const std::string& computeShader,
+	VkPipelineLayout layout
+)
 {
-	recreateResources(context.swapchain.extent);
-
-	hri::DescriptorSetLayoutBuilder rngDescriptorSetLayoutBuilder(context);
-	rngDescriptorSetLayoutBuilder
-		.addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
-
-	rngDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(rngDescriptorSetLayoutBuilder.build());
-	rngDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *rngDescriptorSetLayout));
+	// Both local_size_x_id (0) and local_size_y_id (1) read the same tile size
+	VkSpecializationMapEntry mapEntries[] = {
+		VkSpecializationMapEntry{ 0, 0, sizeof(uint32_t) },
+		VkSpecializationMapEntry{ 1, 0, sizeof(uint32_t) },
+	};
 
-	hri::PipelineLayoutBuilder layoutBuilder(context);
-	m_layout = layoutBuilder
-		.addPushConstant(sizeof(RngGenerationPass::PushConstantData), VK_SHADER_STAGE_COMPUTE_BIT)
-		.addDescriptorSetLayout(*rngDescriptorSetLayout)
-		.build();
+	std::unordered_map<uint32_t, hri::PipelineStateObject*> pipelines;
+	for (uint32_t tileSize : gComputeTileSizes)
+	{
+		VkSpecializationInfo specializationInfo = VkSpecializationInfo{};
+		specializationInfo.mapEntryCount = HRI_SIZEOF_ARRAY(mapEntries);
+		specializationInfo.pMapEntries = mapEntries;
+		specializationInfo.dataSize = sizeof(uint32_t);
+		specializationInfo.pData = &tileSize;
 
-	shaderDB.registerShader("RNGGenCompute", hri::Shader::loadFile(context, "shaders/rng_gen.comp.spv", VK_SHADER_STAGE_COMPUTE_BIT));
-	m_pPSO = shaderDB.createPipeline("RNGGenComputePipeline", "RNGGenCompute", m_layout);
-}
+		pipelines[tileSize] = shaderDB.createPipeline(name + std::to_string(tileSize), computeShader, layout, &specializationInfo);
+	}
 
-RngGenerationPass::~RngGenerationPass()
-{
-	vkDestroyPipelineLayout(context.device, m_layout, nullptr);
+	return pipelines;
 }
 
-void RngGenerationPass::prepareFrame(CommonResources& resources)
+/// @brief Calculate the number of workgroups needed to cover a dimension with tiles.
+/// @param size Dimension size in pixels.
+/// @param tileSize Tile size in pixels.
+/// @return The workgroup count.
+static inline uint32_t tileGroupCount(uint32_t size, uint32_t tileSize)
 {
-	VkDescriptorImageInfo rngSourceInfo = VkDescriptorImageInfo{};
-	rngSourceInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-	rngSourceInfo.imageView = rngSource->view;
-	rngSourceInfo.sampler = VK_NULL_HANDLE;
-
-	(*rngDescriptorSet)
-		.writeImage(0, &rngSourceInfo)
-		.flush();
+	return (size + tileSize - 1) / tileSize;
 }
 
-void RngGenerationPass::drawFrame(hri::ActiveFrame& frame, CommonResources& resources)
+// --- Ray tracing pipeline library helpers ---
+
+/// @brief Create a ray tracing pipeline library containing a single shader group.
+///		The library pipeline is registered in the shader database, which takes ownership of it.
+/// @param ctx Ray Tracing Context to use.
+/// @param shaderDB Shader database to use.
+/// @param name Library pipeline name.
+/// @param layout Pipeline layout, MUST match the layout of pipelines linking this library.
+/// @param type Shader group type.
+/// @param shaders Shaders in this group, general groups use exactly one shader.
+/// @return A new pipeline library.
+static raytracing::RayTracingPipelineLibrary createRayTracingGroupLibrary(
+	raytracing::RayTracingContext& ctx,
+	hri::ShaderDatabase& shaderDB,
+	const std::string& name,
+	VkPipelineLayout layout,
+	VkRayTracingShaderGroupTypeKHR type,
+	const std::vector<const hri::Shader*>& shaders
+)
 {
-	debug.resetTimer();
-	debug.cmdBeginLabel(frame.commandBuffer, "RNG Gen Compute Pass");
-	debug.cmdRecordStartTimestamp(frame.commandBuffer);
+	raytracing::RayTracingPipelineBuilder libraryBuilder(ctx);
 
-	VkImageMemoryBarrier2 rngSourceBarrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
-	rngSourceBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-	rngSourceBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-	rngSourceBarrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
-	rngSourceBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
-	rngSourceBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	rngSourceBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	rngSourceBarrier.image = rngSource->image;
-	rngSourceBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	rngSourceBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-	rngSourceBarrier.subresourceRange = hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1);
-	frame.pipelineBarrier({ rngSourceBarrier });
+	uint32_t generalShader = VK_SHADER_UNUSED_KHR;
+	uint32_t closestHitShader = VK_SHADER_UNUSED_KHR;
+	uint32_t anyHitShader = VK_SHADER_UNUSED_KHR;
+	for (uint32_t shaderIdx = 0; shaderIdx < shaders.size(); shaderIdx++)
+	{
+		const hri::Shader* pShader = shaders[shaderIdx];
+		libraryBuilder.addShaderStage(pShader->stage, pShader->module);
+
+		switch (pShader->stage)
+		{
+		case VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR:
+			closestHitShader = shaderIdx;
+			break;
+		case VK_SHADER_STAGE_ANY_HIT_BIT_KHR:
+			anyHitShader = shaderIdx;
+			break;
+		default:
+			generalShader = shaderIdx;
+			break;
+		}
+	}
 
-	vkCmdBindPipeline(
-		frame.commandBuffer,
-		m_pPSO->bindPoint,
-		m_pPSO->pipeline
-	);
+	libraryBuilder
+		.addRayTracingShaderGroup(type, generalShader, closestHitShader, anyHitShader)
+		.setMaxRecursionDepth()
+		.setLibraryInterface()
+		.setLayout(layout);
 
-	PushConstantData pushConstants = PushConstantData{
-		resources.frameIndex,
-	};
+	raytracing::RayTracingPipelineLibrary library = libraryBuilder.buildLibrary(shaderDB.pipelineCache());
+	shaderDB.registerPipeline(name, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, library.pipeline);
 
-	vkCmdPushConstants(
-		frame.commandBuffer,
-		m_layout,
-		VK_SHADER_STAGE_COMPUTE_BIT,
-		0, sizeof(RngGenerationPass::PushConstantData),
-		&pushConstants
-	);
+	return library;
+}
 
-	VkDescriptorSet sets[] = { rngDescriptorSet->set, };
-	vkCmdBindDescriptorSets(
-		frame.commandBuffer,
-		m_pPSO->bindPoint,
-		m_layout,
-		0, 1, sets,
-		0, nullptr
+// --- Graphics pipeline library helpers ---
+
+/// @brief Create a graphics pipeline by linking separately compiled graphics pipeline library parts.
+///		Parts are cached in the shader database by name, so a vertex input library shared between passes is only compiled once.
+/// @param shaderDB Shader database to use.
+/// @param name Pipeline name, also used as prefix for the pass specific library parts.
+/// @param vertexInputLibrary Vertex input interface library name, passes with identical vertex input state may share it.
+/// @param vertexShader Vertex shader name.
+/// @param fragmentShader Fragment shader name, may be empty for depth only pipelines.
+/// @param pipelineBuilder Pipeline Builder object to use for initialization.
+/// @return A pointer to the linked Pipeline in the Shader Database.
+static hri::PipelineStateObject* createLinkedGraphicsPipeline(
+	hri::ShaderDatabase& shaderDB,
+	const std::string& name,
+	const std::string& vertexInputLibrary,
+	const std::string& vertexShader,
+	const std::string& fragmentShader,
+	const hri::GraphicsPipelineBuilder& pipelineBuilder
+)
+{
+	const std::string preRasterizationLibrary = name + "::PreRasterization";
+	const std::string fragmentShaderLibrary = name + "::FragmentShader";
+	const std::string fragmentOutputLibrary = name + "::FragmentOutput";
+
+	shaderDB.createPipelineLibrary(vertexInputLibrary, VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT, {}, pipelineBuilder);
+	shaderDB.createPipelineLibrary(preRasterizationLibrary, VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT, { vertexShader }, pipelineBuilder);
+	shaderDB.createPipelineLibrary(fragmentShaderLibrary, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, fragmentShader.empty() ? std::vector<std::string>{} : std::vector<std::string>{ fragmentShader }, pipelineBuilder);
+	shaderDB.createPipelineLibrary(fragmentOutputLibrary, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT, {}, pipelineBuilder);
+
+	return shaderDB.linkPipeline(
+		name,
+		{ vertexInputLibrary, preRasterizationLibrary, fragmentShaderLibrary, fragmentOutputLibrary },
+		pipelineBuilder.layout
 	);
+}
 
-	vkCmdDispatch(
-		frame.commandBuffer,
-		rngSource->extent.width,
-		rngSource->extent.height,
-		1
-	);
-	
-	rngSourceBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-	rngSourceBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-	rngSourceBarrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
-	rngSourceBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
-	rngSourceBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
-	rngSourceBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	frame.pipelineBarrier({ rngSourceBarrier });
+// --- IRenderPass ---
 
-	debug.cmdRecordEndTimestamp(frame.commandBuffer);
-	debug.cmdEndLabel(frame.commandBuffer);
+IRenderPass::IRenderPass(hri::RenderContext& ctx)
+	:
+	context(ctx)
+{
+	//
 }
 
-void RngGenerationPass::recreateResources(VkExtent2D resolution)
+void IRenderPass::prepareFrame(CommonResources& resources)
 {
-	rngSource = std::unique_ptr<hri::ImageResource>(new hri::ImageResource(
-		context,
-		VK_IMAGE_TYPE_2D,
-		VK_FORMAT_R32_SFLOAT,
-		VK_SAMPLE_COUNT_1_BIT,
-		VkExtent3D{ resolution.width, resolution.height, 1 },
-		1,
-		1,
-		VK_IMAGE_USAGE_STORAGE_BIT
-		| VK_IMAGE_USAGE_SAMPLED_BIT
-	));
-
-	rngSource->createView(VK_IMAGE_VIEW_TYPE_2D, hri::ImageResource::DefaultComponentMapping(), hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1));
+	// Don't do anything by default
 }
 
 // --- Path Tracing Pass ---
@@ -157,15 +172,17 @@ PathTracingPass::PathTracingPass(raytracing::RayTracingContext& ctx, hri::Shader
 	hri::DescriptorSetLayoutBuilder sceneDescriptorSetLayoutBuilder(context);
 	sceneDescriptorSetLayoutBuilder
 		.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
-		.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
-		.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR);
+		.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
+		.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
+		.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR);
 
 	hri::DescriptorSetLayoutBuilder rtDescriptorSetLayoutBuilder(context);
 	rtDescriptorSetLayoutBuilder
-		.addBinding(0, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR)
+		.addBinding(0, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
 		.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
 		.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
-		.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR);
+		.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
+		.addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR);
 
 	sceneDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(sceneDescriptorSetLayoutBuilder.build());
 	rtDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(rtDescriptorSetLayoutBuilder.build());
@@ -180,18 +197,21 @@ PathTracingPass::PathTracingPass(raytracing::RayTracingContext& ctx, hri::Shader
 		.addDescriptorSetLayout(*rtDescriptorSetLayout)
 		.build();
 
-	hri::Shader* pRayGen = shaderDB.registerShader("PathTracingRayGen", hri::Shader::loadFile(context, "shaders/pt.rgen.spv", VK_SHADER_STAGE_RAYGEN_BIT_KHR));
-	hri::Shader* pMiss = shaderDB.registerShader("PathTracingMiss", hri::Shader::loadFile(context, "shaders/pt.rmiss.spv", VK_SHADER_STAGE_MISS_BIT_KHR));
-	hri::Shader* pCHit = shaderDB.registerShader("PathTracingCHit", hri::Shader::loadFile(context, "shaders/pt.rchit.spv", VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR));
+	hri::Shader* pRayGen = shaderDB.registerShader("PathTracingRayGen", "pt.rgen");
+	hri::Shader* pMiss = shaderDB.registerShader("PathTracingMiss", "pt.rmiss");
+	hri::Shader* pCHit = shaderDB.registerShader("PathTracingCHit", "pt.rchit");
+
+	// Shader groups are compiled once into libraries, the pass pipeline only links them
+	m_rayGenLibrary = createRayTracingGroupLibrary(rtContext, shaderDB, "PathTracingRayGenLibrary", m_layout, VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR, { pRayGen });
+	m_missLibrary = createRayTracingGroupLibrary(rtContext, shaderDB, "PathTracingMissLibrary", m_layout, VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR, { pMiss });
+	m_hitLibrary = createRayTracingGroupLibrary(rtContext, shaderDB, "PathTracingHitLibrary", m_layout, VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR, { pCHit });
 
 	raytracing::RayTracingPipelineBuilder pipelineBuilder(rtContext);
 	pipelineBuilder
-		.addShaderStage(pRayGen->stage, pRayGen->module)
-		.addShaderStage(pMiss->stage, pMiss->module)
-		.addShaderStage(pCHit->stage, pCHit->module)
-		.addRayTracingShaderGroup(VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR, 0)
-		.addRayTracingShaderGroup(VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR, 1)
-		.addRayTracingShaderGroup(VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR, VK_SHADER_UNUSED_KHR, 2)
+		.addLibrary(m_rayGenLibrary)
+		.addLibrary(m_missLibrary)
+		.addLibrary(m_hitLibrary)
+		.setLibraryInterface()
 		.setMaxRecursionDepth()
 		.setLayout(m_layout);
 
@@ -221,10 +241,16 @@ void PathTracingPass::prepareFrame(CommonResources& resources)
 	materialInfo.offset = 0;
 	materialInfo.range = resources.materialSSBO->bufferSize;
 
+	VkDescriptorBufferInfo lightInfo = VkDescriptorBufferInfo{};
+	lightInfo.buffer = resources.lightSSBO->buffer;
+	lightInfo.offset = 0;
+	lightInfo.range = resources.lightSSBO->bufferSize;
+
 	(*sceneDescriptorSet)
 		.writeBuffer(0, &cameraInfo)
 		.writeBuffer(1, &instanceInfo)
 		.writeBuffer(2, &materialInfo)
+		.writeBuffer(3, &lightInfo)
 		.flush();
 
 	VkWriteDescriptorSetAccelerationStructureKHR tlasWrite = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR };
@@ -246,11 +272,17 @@ void PathTracingPass::prepareFrame(CommonResources& resources)
 	renderDepthResultInfo.imageView = renderDepthResult->view;
 	renderDepthResultInfo.sampler = VK_NULL_HANDLE;
 
+	VkDescriptorImageInfo accumulationResultInfo = VkDescriptorImageInfo{};
+	accumulationResultInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+	accumulationResultInfo.imageView = accumulationResult->view;
+	accumulationResultInfo.sampler = VK_NULL_HANDLE;
+
 	(*rtDescriptorSet)
 		.writeEXT(0, &tlasWrite)
 		.writeImage(1, &renderResultInfo)
 		.writeImage(2, &renderNormalResultInfo)
 		.writeImage(3, &renderDepthResultInfo)
+		.writeImage(4, &accumulationResultInfo)
 		.flush();
 }
 
@@ -278,7 +310,13 @@ void PathTracingPass::drawFrame(hri::ActiveFrame& frame, CommonResources& resour
 	VkImageMemoryBarrier2 renderDepthResultBarrier = renderResultBarrier;
 	renderDepthResultBarrier.image = renderDepthResult->image;
 
-	frame.pipelineBarrier({ renderResultBarrier, renderNormalResultBarrier, renderDepthResultBarrier });
+	// Accumulated history is only discarded when accumulation restarts
+	VkImageMemoryBarrier2 accumulationResultBarrier = renderResultBarrier;
+	accumulationResultBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+	accumulationResultBarrier.image = accumulationResult->image;
+	accumulationResultBarrier.oldLayout = m_accumulatedSampleCount == 0 ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_GENERAL;
+
+	frame.pipelineBarrier({ renderResultBarrier, renderNormalResultBarrier, renderDepthResultBarrier, accumulationResultBarrier });
 
 	VkStridedDeviceAddressRegionKHR raygen = m_SBT->getRegion(raytracing::ShaderBindingTable::SGRayGen);
 	VkStridedDeviceAddressRegionKHR miss = m_SBT->getRegion(raytracing::ShaderBindingTable::SGMiss);
@@ -287,6 +325,11 @@ void PathTracingPass::drawFrame(hri::ActiveFrame& frame, CommonResources& resour
 
 	PushConstantData pushConstants = PushConstantData{};
 	pushConstants.frameIdx = resources.frameIndex;
+	pushConstants.maxBounceCount = maxBounceCount;
+	pushConstants.rouletteBounceCount = rouletteBounceCount;
+	pushConstants.lightCount = resources.lightCount;
+	pushConstants.samplesPerPixel = hri::max<uint32_t>(samplesPerPixel, 1);
+	pushConstants.accumulatedSampleCount = progressiveAccumulation ? m_accumulatedSampleCount : 0;
 
 	vkCmdPushConstants(
 		frame.commandBuffer,
@@ -322,6 +365,8 @@ void PathTracingPass::drawFrame(hri::ActiveFrame& frame, CommonResources& resour
 		1
 	);
 
+	m_accumulatedSampleCount = pushConstants.accumulatedSampleCount + pushConstants.samplesPerPixel;
+
 	renderResultBarrier.srcStageMask = VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR;
 	renderResultBarrier.dstStageMask = VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR;
 	renderResultBarrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
@@ -343,12 +388,19 @@ void PathTracingPass::drawFrame(hri::ActiveFrame& frame, CommonResources& resour
 
 void PathTracingPass::recreateResources(VkExtent2D resolution)
 {
+	// Targets are only addressed by pixel within the swap extent, so they are over-allocated & only grow
+	resetAccumulation();
+	if (resolution.width <= m_allocatedExtent.width && resolution.height <= m_allocatedExtent.height)
+		return;
+
+	m_allocatedExtent = hri::overallocateExtent(resolution, m_allocatedExtent);
+
 	renderResult = std::unique_ptr<hri::ImageResource>(new hri::ImageResource(
 		context,
 		VK_IMAGE_TYPE_2D,
 		VK_FORMAT_R32G32B32A32_SFLOAT,
 		VK_SAMPLE_COUNT_1_BIT,
-		VkExtent3D{ resolution.width, resolution.height, 1 },
+		VkExtent3D{ m_allocatedExtent.width, m_allocatedExtent.height, 1 },
 		1,
 		1,
 		VK_IMAGE_USAGE_STORAGE_BIT
@@ -360,7 +412,7 @@ void PathTracingPass::recreateResources(VkExtent2D resolution)
 		VK_IMAGE_TYPE_2D,
 		VK_FORMAT_R32G32B32A32_SFLOAT,
 		VK_SAMPLE_COUNT_1_BIT,
-		VkExtent3D{ resolution.width, resolution.height, 1 },
+		VkExtent3D{ m_allocatedExtent.width, m_allocatedExtent.height, 1 },
 		1,
 		1,
 		VK_IMAGE_USAGE_STORAGE_BIT
@@ -372,119 +424,339 @@ void PathTracingPass::recreateResources(VkExtent2D resolution)
 		VK_IMAGE_TYPE_2D,
 		VK_FORMAT_R32_SFLOAT,
 		VK_SAMPLE_COUNT_1_BIT,
-		VkExtent3D{ resolution.width, resolution.height, 1 },
+		VkExtent3D{ m_allocatedExtent.width, m_allocatedExtent.height, 1 },
 		1,
 		1,
 		VK_IMAGE_USAGE_STORAGE_BIT
 		| VK_IMAGE_USAGE_SAMPLED_BIT
 	));
 
+	accumulationResult = std::unique_ptr<hri::ImageResource>(new hri::ImageResource(
+		context,
+		VK_IMAGE_TYPE_2D,
+		VK_FORMAT_R32G32B32A32_SFLOAT,
+		VK_SAMPLE_COUNT_1_BIT,
+		VkExtent3D{ m_allocatedExtent.width, m_allocatedExtent.height, 1 },
+		1,
+		1,
+		VK_IMAGE_USAGE_STORAGE_BIT
+	));
+
 	renderResult->createView(VK_IMAGE_VIEW_TYPE_2D, hri::ImageResource::DefaultComponentMapping(), hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1));
 	renderNormalResult->createView(VK_IMAGE_VIEW_TYPE_2D, hri::ImageResource::DefaultComponentMapping(), hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1));
 	renderDepthResult->createView(VK_IMAGE_VIEW_TYPE_2D, hri::ImageResource::DefaultComponentMapping(), hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1));
+	accumulationResult->createView(VK_IMAGE_VIEW_TYPE_2D, hri::ImageResource::DefaultComponentMapping(), hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1));
 }
 
 // --- GBUFFER LAYOUT PASS ---
 
-GBufferLayoutPass::GBufferLayoutPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator)
+GBufferLayoutPass::GBufferLayoutPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator, bool singlePassLOD, bool visibilityBuffer, bool packedGBuffer, bool depthPrepass)
 	:
-	IRenderPass(ctx)
+	IRenderPass(ctx),
+	m_singlePassLOD(singlePassLOD),
+	m_visibilityBuffer(visibilityBuffer),
+	m_packedGBuffer(packedGBuffer),
+	m_depthPrepass(depthPrepass),
+	m_passCount(singlePassLOD ? 1 : 2)
 {
+	// Target encoding is compiled into the shaders, so the formats must follow the same config
+	assert(packedGBuffer == (DEMO_PACKED_GBUFFER == 1));
+
 	// Set up descriptor set
 	{
 		hri::DescriptorSetLayoutBuilder sceneDescriptorSetLayoutBuilder(context);
 		sceneDescriptorSetLayoutBuilder
 			.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
 			.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
-			.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT);
+			.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT);
 
 		sceneDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(sceneDescriptorSetLayoutBuilder.build());
 		sceneDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *sceneDescriptorSetLayout));
+
+		hri::DescriptorSetLayoutBuilder cullDescriptorSetLayoutBuilder(context);
+		cullDescriptorSetLayoutBuilder
+			.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(6, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(8, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
+
+		cullDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(cullDescriptorSetLayoutBuilder.build());
+		cullDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *cullDescriptorSetLayout));
+
+		hri::DescriptorSetLayoutBuilder hiZDescriptorSetLayoutBuilder(context);
+		hiZDescriptorSetLayoutBuilder
+			.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+			.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+
+		// One set per Hi-Z mip, each reading the previous mip & writing its own
+		hiZDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(hiZDescriptorSetLayoutBuilder.build());
+		for (uint32_t mipLevel = 0; mipLevel < DEMO_HIZ_MAX_MIP_COUNT; mipLevel++)
+		{
+			hiZDescriptorSets.push_back(std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *hiZDescriptorSetLayout)));
+		}
+
+		if (m_visibilityBuffer)
+		{
+			hri::DescriptorSetLayoutBuilder resolveDescriptorSetLayoutBuilder(context);
+			resolveDescriptorSetLayoutBuilder
+				.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+				.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+				.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+				.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+				.addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+				.addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+				.addBinding(6, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+				.addBinding(7, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+				.addBinding(8, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+				.addBinding(9, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+				.addBinding(10, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+
+			resolveDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(resolveDescriptorSetLayoutBuilder.build());
+			for (uint32_t layer = 0; layer < LODLayerCount; layer++)
+			{
+				resolveDescriptorSets.push_back(std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *resolveDescriptorSetLayout)));
+			}
+		}
+	}
+
+	// Set up culling pipelines
+	{
+		hri::PipelineLayoutBuilder cullLayoutBuilder(context);
+		m_cullLayout = cullLayoutBuilder
+			.addPushConstant(sizeof(GBufferLayoutPass::CullPushConstantData), VK_SHADER_STAGE_COMPUTE_BIT)
+			.addDescriptorSetLayout(*cullDescriptorSetLayout)
+			.build();
+
+		shaderDB.registerShader("GBufferCullCompute", "gbuffer_cull.comp");
+		shaderDB.registerShader("GBufferCompactDrawsCompute", "gbuffer_compact_draws.comp");
+
+		m_pCullPSO = shaderDB.createPipeline("GBufferCullPipeline", "GBufferCullCompute", m_cullLayout);
+		m_pCompactPSO = shaderDB.createPipeline("GBufferCompactDrawsPipeline", "GBufferCompactDrawsCompute", m_cullLayout);
+
+		hri::PipelineLayoutBuilder hiZLayoutBuilder(context);
+		m_hiZLayout = hiZLayoutBuilder
+			.addPushConstant(sizeof(GBufferLayoutPass::HiZPushConstantData), VK_SHADER_STAGE_COMPUTE_BIT)
+			.addDescriptorSetLayout(*hiZDescriptorSetLayout)
+			.build();
+
+		shaderDB.registerShader("GBufferHiZCompute", "gbuffer_hiz.comp");
+		m_pHiZPSO = shaderDB.createPipeline("GBufferHiZPipeline", "GBufferHiZCompute", m_hiZLayout);
+
+		if (m_visibilityBuffer)
+		{
+			hri::PipelineLayoutBuilder resolveLayoutBuilder(context);
+			m_resolveLayout = resolveLayoutBuilder
+				.addDescriptorSetLayout(*resolveDescriptorSetLayout)
+				.build();
+
+			shaderDB.registerShader("GBufferResolveCompute", "gbuffer_resolve.comp");
+			m_pResolvePSO = shaderDB.createPipeline("GBufferResolvePipeline", "GBufferResolveCompute", m_resolveLayout);
+		}
 	}
 
 	// Set up render pass
 	{
-		hri::RenderPassBuilder passBuilder(context);
-		passBuilder
-			.addAttachment( // Albedo target
-				VK_FORMAT_R8G8B8A8_SNORM, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
-			)
-			.addAttachment( // Emission target
-				VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
-			)
-			.addAttachment( // Specular target
-				VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
-			)
-			.addAttachment( // Transmittance target
-				VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
-			)
-			.addAttachment( // Normal target
-				VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
-			)
-			.addAttachment( // LOD Mask target (SFLOAT, but converted in sample pass to UINT32)
-				VK_FORMAT_R32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
-			)
-			.addAttachment( // Depth target
-				VK_FORMAT_D32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
-			)
-			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
-			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
-			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
-			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 3, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
-			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 4, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
-			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 5, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
-			.setAttachmentReference(hri::AttachmentType::DepthStencil, VkAttachmentReference{ 6, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL });
+		// Packed targets hold encoded normals & material parameters in compact formats (see gbuffer_packing.glsl),
+		// sRGB formats do not support storage so the visibility buffer resolve writes linear albedo instead.
+		// The normal target also holds screen space velocity in zw
+		const VkFormat albedoFormat = !m_packedGBuffer ? VK_FORMAT_R8G8B8A8_SNORM : (m_visibilityBuffer ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_R8G8B8A8_SRGB);
+		const VkFormat emissionFormat = m_packedGBuffer ? VK_FORMAT_R16G16B16A16_SFLOAT : VK_FORMAT_R32G32B32A32_SFLOAT;
+		const VkFormat materialFormat = m_packedGBuffer ? VK_FORMAT_R8G8B8A8_UNORM : VK_FORMAT_R32G32B32A32_SFLOAT;
+		const VkFormat normalFormat = m_packedGBuffer ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R32G32B32A32_SFLOAT;
+		const VkFormat lodMaskFormat = m_packedGBuffer ? VK_FORMAT_R16_SFLOAT : VK_FORMAT_R32_SFLOAT;
+
+		// The load pass is compatible with the clearing pass, it continues the LOD layouts after occlusion culling
+		auto buildRenderPass = [&](VkAttachmentLoadOp loadOp, VkImageLayout initialLayout) {
+			// In visibility buffer mode the G-buffer targets are not rasterized, only transitioned for the resolve pass
+			VkAttachmentLoadOp targetLoadOp = m_visibilityBuffer ? VK_ATTACHMENT_LOAD_OP_DONT_CARE : loadOp;
+			VkAttachmentStoreOp targetStoreOp = m_visibilityBuffer ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+			VkImageLayout targetInitialLayout = m_visibilityBuffer ? VK_IMAGE_LAYOUT_UNDEFINED : initialLayout;
+			VkImageLayout targetFinalLayout = m_visibilityBuffer ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			// With a depth prepass the G-buffer subpass only tests depth, so it is read only there
+			VkImageLayout gbufferDepthLayout = m_depthPrepass ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+			hri::RenderPassBuilder passBuilder(context);
+			passBuilder
+				.addAttachment( // Albedo target
+					albedoFormat, VK_SAMPLE_COUNT_1_BIT, targetFinalLayout,
+					targetLoadOp, targetStoreOp, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE, targetInitialLayout
+				)
+				.addAttachment( // Emission target
+					emissionFormat, VK_SAMPLE_COUNT_1_BIT, targetFinalLayout,
+					targetLoadOp, targetStoreOp, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE, targetInitialLayout
+				)
+				.addAttachment( // Specular target
+					materialFormat, VK_SAMPLE_COUNT_1_BIT, targetFinalLayout,
+					targetLoadOp, targetStoreOp, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE, targetInitialLayout
+				)
+				.addAttachment( // Transmittance target
+					materialFormat, VK_SAMPLE_COUNT_1_BIT, targetFinalLayout,
+					targetLoadOp, targetStoreOp, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE, targetInitialLayout
+				)
+				.addAttachment( // Normal target
+					normalFormat, VK_SAMPLE_COUNT_1_BIT, targetFinalLayout,
+					targetLoadOp, targetStoreOp, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE, targetInitialLayout
+				)
+				.addAttachment( // LOD Mask target (SFLOAT, but converted in sample pass to UINT32)
+					lodMaskFormat, VK_SAMPLE_COUNT_1_BIT, targetFinalLayout,
+					targetLoadOp, targetStoreOp, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE, targetInitialLayout
+				)
+				.addAttachment( // Depth target
+					VK_FORMAT_D32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+					loadOp, VK_ATTACHMENT_STORE_OP_STORE, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE, initialLayout
+				);
+
+			if (m_visibilityBuffer)
+			{
+				passBuilder
+					.addAttachment( // Visibility target (draw instance index, primitive index)
+						VK_FORMAT_R32G32_UINT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+						loadOp, VK_ATTACHMENT_STORE_OP_STORE, VK_ATTACHMENT_LOAD_OP_DONT_CARE, VK_ATTACHMENT_STORE_OP_DONT_CARE, initialLayout
+					);
+			}
+
+			// The second culling phase loads the targets written by the first phase, their writes must be visible before the load
+			// and the layout transition. Depth is also read by the Hi-Z build in between. Both variants declare these so the passes stay compatible
+			const uint32_t colorSubpass = m_depthPrepass ? GBufferSubpass : 0;
+			passBuilder
+				.addDependency(
+					VK_SUBPASS_EXTERNAL, 0,
+					VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+					VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+					VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+					VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+				)
+				.addDependency(
+					VK_SUBPASS_EXTERNAL, colorSubpass,
+					VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+					VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+					VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+					VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+				);
+
+			if (m_depthPrepass)
+			{
+				// Depth prepass subpass, the G-buffer subpass follows it
+				passBuilder
+					.setAttachmentReference(hri::AttachmentType::DepthStencil, VkAttachmentReference{ DepthAttachment, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL })
+					.nextSubpass()
+					.addDependency(
+						DepthPrepassSubpass, GBufferSubpass,
+						VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+						VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+						VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+						VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT,
+						VK_DEPENDENCY_BY_REGION_BIT
+					);
+			}
+
+			if (m_visibilityBuffer)
+			{
+				passBuilder
+					.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ VisibilityAttachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+			}
+			else
+			{
+				passBuilder
+					.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
+					.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
+					.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
+					.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 3, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
+					.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 4, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
+					.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 5, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+			}
+
+			return passBuilder
+				.setAttachmentReference(hri::AttachmentType::DepthStencil, VkAttachmentReference{ DepthAttachment, gbufferDepthLayout })
+				.build();
+		};
+
+		m_loadRenderPass = buildRenderPass(VK_ATTACHMENT_LOAD_OP_LOAD, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
 		// Attachment configs
 		std::vector<hri::RenderAttachmentConfig> attachmentConfigs = {
-			hri::RenderAttachmentConfig{ VK_FORMAT_R8G8B8A8_SNORM, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
-			hri::RenderAttachmentConfig{ VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
-			hri::RenderAttachmentConfig{ VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
-			hri::RenderAttachmentConfig{ VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
-			hri::RenderAttachmentConfig{ VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
-			hri::RenderAttachmentConfig{ VK_FORMAT_R32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
+			hri::RenderAttachmentConfig{ albedoFormat, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
+			hri::RenderAttachmentConfig{ emissionFormat, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
+			hri::RenderAttachmentConfig{ materialFormat, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
+			hri::RenderAttachmentConfig{ materialFormat, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
+			hri::RenderAttachmentConfig{ normalFormat, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
+			hri::RenderAttachmentConfig{ lodMaskFormat, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
 			hri::RenderAttachmentConfig{ VK_FORMAT_D32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_DEPTH_BIT },
 		};
 
-		loDefLODPassResources = std::make_unique<hri::RenderPassResourceManager>(ctx, passBuilder.build(), attachmentConfigs);
-		hiDefLODPassResources = std::make_unique<hri::RenderPassResourceManager>(ctx, passBuilder.build(), attachmentConfigs);
-
-		// lo def clear values
-		loDefLODPassResources->setClearValue(0, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
-		loDefLODPassResources->setClearValue(1, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
-		loDefLODPassResources->setClearValue(2, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
-		loDefLODPassResources->setClearValue(3, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
-		loDefLODPassResources->setClearValue(4, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
-		loDefLODPassResources->setClearValue(5, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
-		loDefLODPassResources->setClearValue(6, VkClearValue{ { 1.0f, 0x00 } });
-
-		// hi def clear values
-		hiDefLODPassResources->setClearValue(0, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
-		hiDefLODPassResources->setClearValue(1, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
-		hiDefLODPassResources->setClearValue(2, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
-		hiDefLODPassResources->setClearValue(3, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
-		hiDefLODPassResources->setClearValue(4, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
-		hiDefLODPassResources->setClearValue(5, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
-		hiDefLODPassResources->setClearValue(6, VkClearValue{ { 1.0f, 0x00 } });
+		if (m_visibilityBuffer)
+		{
+			// G-buffer targets are written by the resolve pass
+			for (uint32_t targetIdx = 0; targetIdx < GBufferTargetCount; targetIdx++)
+			{
+				attachmentConfigs[targetIdx].usage |= VK_IMAGE_USAGE_STORAGE_BIT;
+			}
+
+			attachmentConfigs.push_back(hri::RenderAttachmentConfig{ VK_FORMAT_R32G32_UINT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT });
+		}
+
+		auto setClearValues = [&](hri::RenderPassResourceManager& resourceManager) {
+			resourceManager.setClearValue(0, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
+			resourceManager.setClearValue(1, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
+			resourceManager.setClearValue(2, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
+			resourceManager.setClearValue(3, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
+			resourceManager.setClearValue(4, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
+			resourceManager.setClearValue(5, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
+			resourceManager.setClearValue(6, VkClearValue{ { 1.0f, 0x00 } });
+
+			if (m_visibilityBuffer)
+			{
+				// Empty visibility is marked with an invalid draw instance index
+				VkClearValue visibilityClearValue = VkClearValue{};
+				visibilityClearValue.color.uint32[0] = UINT32_MAX;
+				visibilityClearValue.color.uint32[1] = UINT32_MAX;
+				resourceManager.setClearValue(VisibilityAttachment, visibilityClearValue);
+			}
+		};
+
+		if (m_singlePassLOD)
+		{
+			// Both LOD layouts share layered attachments, the LOD layer is selected per draw in the vertex shader
+			for (auto& config : attachmentConfigs)
+			{
+				config.layers = LODLayerCount;
+			}
+
+			layeredLODPassResources = std::make_unique<hri::RenderPassResourceManager>(ctx, buildRenderPass(VK_ATTACHMENT_LOAD_OP_CLEAR, VK_IMAGE_LAYOUT_UNDEFINED), attachmentConfigs);
+			setClearValues(*layeredLODPassResources);
+		}
+		else
+		{
+			loDefLODPassResources = std::make_unique<hri::RenderPassResourceManager>(ctx, buildRenderPass(VK_ATTACHMENT_LOAD_OP_CLEAR, VK_IMAGE_LAYOUT_UNDEFINED), attachmentConfigs);
+			hiDefLODPassResources = std::make_unique<hri::RenderPassResourceManager>(ctx, buildRenderPass(VK_ATTACHMENT_LOAD_OP_CLEAR, VK_IMAGE_LAYOUT_UNDEFINED), attachmentConfigs);
+			setClearValues(*loDefLODPassResources);
+			setClearValues(*hiDefLODPassResources);
+		}
 	}
 
 	// Set up render pipeline
 	{
 		hri::PipelineLayoutBuilder layoutBuilder(context);
 		m_layout = layoutBuilder
-			.addPushConstant(sizeof(GBufferLayoutPass::PushConstantData), VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
 			.addDescriptorSetLayout(*sceneDescriptorSetLayout)
 			.build();
 
-		shaderDB.registerShader("StaticVert", hri::Shader::loadFile(context, "shaders/static.vert.spv", VK_SHADER_STAGE_VERTEX_BIT));
-		shaderDB.registerShader("GBufferLayoutFrag", hri::Shader::loadFile(context, "shaders/gbuffer_layout.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT));
+		shaderDB.registerShader("StaticVert", "static.vert");
+		shaderDB.registerShader("GBufferLayoutFrag", "gbuffer_layout.frag");
+		shaderDB.registerShader("DepthPrepassVert", "depth_prepass.vert");
+
+		// Visibility fragment shader needs the geometry shader feature for gl_PrimitiveID, only load it when used
+		if (m_visibilityBuffer)
+			shaderDB.registerShader("GBufferVisibilityFrag", "gbuffer_visibility.frag");
 
 		VkExtent2D swapExtent = context.swapchain.extent;
 		std::vector<VkPipelineColorBlendAttachmentState> blendAttachments = {
@@ -568,6 +840,10 @@ GBufferLayoutPass::GBufferLayoutPass(hri::RenderContext& ctx, hri::ShaderDatabas
 			},
 		};
 
+		// The visibility buffer is the only color attachment in visibility buffer mode
+		if (m_visibilityBuffer)
+			blendAttachments.resize(1);
+
 		hri::GraphicsPipelineBuilder pipelineBuilder = hri::GraphicsPipelineBuilder{};
 		pipelineBuilder.vertexInputBindings = { VkVertexInputBindingDescription{ 0, sizeof(hri::Vertex), VK_VERTEX_INPUT_RATE_VERTEX } };
 		pipelineBuilder.vertexInputAttributes = {
@@ -585,20 +861,87 @@ GBufferLayoutPass::GBufferLayoutPass(hri::RenderContext& ctx, hri::ShaderDatabas
 		pipelineBuilder.colorBlendState = hri::GraphicsPipelineBuilder::initColorBlendState(blendAttachments);
 		pipelineBuilder.dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
 		pipelineBuilder.layout = m_layout;
-		pipelineBuilder.renderPass = loDefLODPassResources->renderPass();	// This is OK because lo & hi def both use the same render pass setup
+		pipelineBuilder.renderPass = m_singlePassLOD ? layeredLODPassResources->renderPass() : loDefLODPassResources->renderPass();	// This is OK because all LOD passes use the same render pass setup
 		pipelineBuilder.subpass = 0;
 
-		m_pPSO = shaderDB.createPipeline("GBufferLayoutPipeline", { "StaticVert", "GBufferLayoutFrag" }, pipelineBuilder);
+		if (m_depthPrepass)
+		{
+			// Depth only pipeline reading the position only stream, without fragment shader or color outputs
+			std::vector<VkPipelineColorBlendAttachmentState> depthBlendAttachments = {};
+
+			hri::GraphicsPipelineBuilder depthPipelineBuilder = pipelineBuilder;
+			depthPipelineBuilder.vertexInputBindings = { VkVertexInputBindingDescription{ 0, sizeof(hri::Float3), VK_VERTEX_INPUT_RATE_VERTEX } };
+			depthPipelineBuilder.vertexInputAttributes = { VkVertexInputAttributeDescription{ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 } };
+			depthPipelineBuilder.colorBlendState = hri::GraphicsPipelineBuilder::initColorBlendState(depthBlendAttachments);
+			depthPipelineBuilder.subpass = DepthPrepassSubpass;
+
+			m_pDepthPrepassPSO = createLinkedGraphicsPipeline(shaderDB, "GBufferDepthPrepassPipeline", "PositionVertexInputLibrary", "DepthPrepassVert", "", depthPipelineBuilder);
+
+			// Each pixel's G-buffer targets are written once, by the fragment that won the depth prepass
+			pipelineBuilder.depthStencilState = hri::GraphicsPipelineBuilder::initDepthStencilState(true, false, VK_COMPARE_OP_EQUAL);
+			pipelineBuilder.subpass = GBufferSubpass;
+		}
+
+		if (m_visibilityBuffer)
+		{
+			m_pPSO = createLinkedGraphicsPipeline(shaderDB, "GBufferVisibilityPipeline", "StaticVertexInputLibrary", "StaticVert", "GBufferVisibilityFrag", pipelineBuilder);
+		}
+		else
+		{
+			m_pPSO = createLinkedGraphicsPipeline(shaderDB, "GBufferLayoutPipeline", "StaticVertexInputLibrary", "StaticVert", "GBufferLayoutFrag", pipelineBuilder);
+		}
 	}
+
+	// Set up Hi-Z pyramid
+	nearestSampler = std::unique_ptr<hri::ImageSampler>(new hri::ImageSampler(
+		context,
+		VK_FILTER_NEAREST,
+		VK_FILTER_NEAREST,
+		VK_SAMPLER_MIPMAP_MODE_NEAREST,
+		VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE,
+		VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE
+	));
+
+	createHiZResources();
 }
 
 GBufferLayoutPass::~GBufferLayoutPass()
 {
+	destroyHiZResources();
+	vkDestroyRenderPass(context.device, m_loadRenderPass, nullptr);
 	vkDestroyPipelineLayout(context.device, m_layout, nullptr);
+	vkDestroyPipelineLayout(context.device, m_cullLayout, nullptr);
+	vkDestroyPipelineLayout(context.device, m_hiZLayout, nullptr);
+	vkDestroyPipelineLayout(context.device, m_resolveLayout, nullptr);
 }
 
 void GBufferLayoutPass::prepareFrame(CommonResources& resources)
 {
+	const SceneGraph& scene = *resources.activeScene;
+	if (drawCommandTemplates == nullptr || m_meshCount != static_cast<uint32_t>(scene.meshes.size()))
+		createDrawBuffers(scene);
+
+	// Upload render instances for culling
+	const auto& instances = scene.getRenderInstanceList();
+	m_renderInstanceCount = static_cast<uint32_t>(instances.size());
+
+	size_t renderInstanceSize = hri::max<size_t>(instances.size(), 1) * sizeof(RenderInstance);
+	if (renderInstanceSSBO == nullptr || renderInstanceSSBO->bufferSize < renderInstanceSize)
+	{
+		renderInstanceSSBO = std::unique_ptr<hri::BufferResource>(new hri::BufferResource(context, renderInstanceSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true));
+	}
+
+	if (!instances.empty())
+		renderInstanceSSBO->copyToBuffer(instances.data(), instances.size() * sizeof(RenderInstance));
+
+	// Occluded draw list holds a count followed by at most 2 draws (near & far) per render instance
+	size_t occludedDrawSize = (1 + 2 * hri::max<size_t>(instances.size(), 1)) * sizeof(uint32_t);
+	if (occludedDrawSSBO == nullptr || occludedDrawSSBO->bufferSize < occludedDrawSize)
+	{
+		occludedDrawSSBO = std::unique_ptr<hri::BufferResource>(new hri::BufferResource(context, occludedDrawSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT));
+	}
+
 	VkDescriptorBufferInfo cameraInfo = VkDescriptorBufferInfo{};
 	cameraInfo.buffer = resources.cameraUBO->buffer;
 	cameraInfo.offset = 0;
@@ -614,11 +957,94 @@ void GBufferLayoutPass::prepareFrame(CommonResources& resources)
 	materialInfo.offset = 0;
 	materialInfo.range = resources.materialSSBO->bufferSize;
 
+	VkDescriptorBufferInfo drawInstanceInfo = VkDescriptorBufferInfo{};
+	drawInstanceInfo.buffer = drawInstanceSSBO->buffer;
+	drawInstanceInfo.offset = 0;
+	drawInstanceInfo.range = drawInstanceSSBO->bufferSize;
+
+	VkDescriptorBufferInfo renderInstanceInfo = VkDescriptorBufferInfo{};
+	renderInstanceInfo.buffer = renderInstanceSSBO->buffer;
+	renderInstanceInfo.offset = 0;
+	renderInstanceInfo.range = renderInstanceSSBO->bufferSize;
+
+	VkDescriptorBufferInfo drawCommandInfo = VkDescriptorBufferInfo{};
+	drawCommandInfo.buffer = drawCommandSSBO->buffer;
+	drawCommandInfo.offset = 0;
+	drawCommandInfo.range = drawCommandSSBO->bufferSize;
+
+	VkDescriptorBufferInfo visibleDrawCommandInfo = VkDescriptorBufferInfo{};
+	visibleDrawCommandInfo.buffer = visibleDrawCommandSSBO->buffer;
+	visibleDrawCommandInfo.offset = 0;
+	visibleDrawCommandInfo.range = visibleDrawCommandSSBO->bufferSize;
+
+	VkDescriptorBufferInfo drawCountInfo = VkDescriptorBufferInfo{};
+	drawCountInfo.buffer = drawCountSSBO->buffer;
+	drawCountInfo.offset = 0;
+	drawCountInfo.range = drawCountSSBO->bufferSize;
+
+	VkDescriptorImageInfo hiZInfo = VkDescriptorImageInfo{};
+	hiZInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+	hiZInfo.imageView = hiZPyramid->view;
+	hiZInfo.sampler = nearestSampler->sampler;
+
+	VkDescriptorBufferInfo occludedDrawInfo = VkDescriptorBufferInfo{};
+	occludedDrawInfo.buffer = occludedDrawSSBO->buffer;
+	occludedDrawInfo.offset = 0;
+	occludedDrawInfo.range = occludedDrawSSBO->bufferSize;
+
 	(*sceneDescriptorSet)
 		.writeBuffer(0, &cameraInfo)
 		.writeBuffer(1, &instanceInfo)
 		.writeBuffer(2, &materialInfo)
+		.writeBuffer(3, &drawInstanceInfo)
+		.flush();
+
+	(*cullDescriptorSet)
+		.writeBuffer(0, &cameraInfo)
+		.writeBuffer(1, &instanceInfo)
+		.writeBuffer(2, &renderInstanceInfo)
+		.writeBuffer(3, &drawCommandInfo)
+		.writeBuffer(4, &visibleDrawCommandInfo)
+		.writeBuffer(5, &drawCountInfo)
+		.writeBuffer(6, &drawInstanceInfo)
+		.writeImage(7, &hiZInfo)
+		.writeBuffer(8, &occludedDrawInfo)
 		.flush();
+
+	if (m_visibilityBuffer)
+	{
+		for (uint32_t layer = 0; layer < LODLayerCount; layer++)
+		{
+			LODMode mode = (layer == LODNearLayer) ? LODMode::LODNear : LODMode::LODFar;
+
+			VkDescriptorImageInfo visibilityInfo = VkDescriptorImageInfo{};
+			visibilityInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			visibilityInfo.imageView = getLODAttachmentView(mode, VisibilityAttachment);
+			visibilityInfo.sampler = nearestSampler->sampler;
+
+			VkDescriptorImageInfo targetInfos[GBufferTargetCount] = {};
+			for (uint32_t targetIdx = 0; targetIdx < GBufferTargetCount; targetIdx++)
+			{
+				targetInfos[targetIdx].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+				targetInfos[targetIdx].imageView = getLODAttachmentView(mode, targetIdx);
+				targetInfos[targetIdx].sampler = VK_NULL_HANDLE;
+			}
+
+			(*resolveDescriptorSets[layer])
+				.writeBuffer(0, &cameraInfo)
+				.writeBuffer(1, &instanceInfo)
+				.writeBuffer(2, &materialInfo)
+				.writeBuffer(3, &drawInstanceInfo)
+				.writeImage(4, &visibilityInfo)
+				.writeImage(5, &targetInfos[0])
+				.writeImage(6, &targetInfos[1])
+				.writeImage(7, &targetInfos[2])
+				.writeImage(8, &targetInfos[3])
+				.writeImage(9, &targetInfos[4])
+				.writeImage(10, &targetInfos[5])
+				.flush();
+		}
+	}
 }
 
 void GBufferLayoutPass::drawFrame(hri::ActiveFrame& frame, CommonResources& resources)
@@ -626,12 +1052,57 @@ void GBufferLayoutPass::drawFrame(hri::ActiveFrame& frame, CommonResources& reso
 	debug.resetTimer();
 	debug.cmdRecordStartTimestamp(frame.commandBuffer);
 
-	executeGBufferPass(*loDefLODPassResources, frame, resources, LODMode::LODFar);
-	executeGBufferPass(*hiDefLODPassResources, frame, resources, LODMode::LODNear);
+	auto drawLODLayouts = [&](bool loadAttachments) {
+		if (m_singlePassLOD)
+		{
+			executeGBufferPass(*layeredLODPassResources, frame, resources, 0, loadAttachments, "GBuffer Layout LOD Layered");
+		}
+		else
+		{
+			executeGBufferPass(*loDefLODPassResources, frame, resources, LODFarPass, loadAttachments, "GBuffer Layout LOD Far");
+			executeGBufferPass(*hiDefLODPassResources, frame, resources, LODNearPass, loadAttachments, "GBuffer Layout LOD Near");
+		}
+	};
+
+	// The Hi-Z pyramid is kept in the general layout, it only needs a transition after (re)creation
+	if (!m_hiZValid)
+	{
+		VkImageMemoryBarrier2 hiZBarrier = VkImageMemoryBarrier2{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+		hiZBarrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+		hiZBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		hiZBarrier.srcAccessMask = VK_ACCESS_2_NONE;
+		hiZBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+		hiZBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		hiZBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		hiZBarrier.image = hiZPyramid->image;
+		hiZBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		hiZBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+		hiZBarrier.subresourceRange = hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, m_hiZMipCount, 0, 1);
+		frame.pipelineBarrier({ hiZBarrier });
+	}
+
+	// First phase draws everything that was visible in last frame's Hi-Z
+	executeCullPass(frame, CullPhaseVisible);
+	drawLODLayouts(false);
+
+	// Second phase re-tests the rejected draws against the Hi-Z of the first phase's depth
+	buildHiZ(frame);
+	executeCullPass(frame, CullPhaseOccluded);
+	drawLODLayouts(true);
 
+	// Rebuild with the full depth so draws from the second phase also occlude in the next frame's first phase
+	buildHiZ(frame);
+	m_hiZValid = true;
+
+	if (m_visibilityBuffer)
+		executeResolvePass(frame);
+
+	// G-buffer layouts are sampled by fragment shaders, or by ray tracing & compute shaders when shading is fused
 	VkMemoryBarrier2 memoryBarrier = VkMemoryBarrier2{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
 	memoryBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-	memoryBarrier.dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+	memoryBarrier.dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT
+		| VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR
+		| VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
 	memoryBarrier.srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
 	memoryBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
 	frame.pipelineBarrier({ memoryBarrier });
@@ -639,142 +1110,549 @@ void GBufferLayoutPass::drawFrame(hri::ActiveFrame& frame, CommonResources& reso
 	debug.cmdRecordEndTimestamp(frame.commandBuffer);
 }
 
-void GBufferLayoutPass::executeGBufferPass(hri::RenderPassResourceManager& resourceManager, hri::ActiveFrame& frame, CommonResources& resources, LODMode mode)
+VkImageView GBufferLayoutPass::getLODAttachmentView(LODMode mode, uint32_t attachmentIndex) const
 {
-	debug.cmdBeginLabel(frame.commandBuffer, (mode == LODMode::LODNear) ? "GBuffer Layout LOD Near" : "GBuffer Layout LOD Far");
-	resourceManager.beginRenderPass(frame);
+	if (m_singlePassLOD)
+	{
+		uint32_t layer = (mode == LODMode::LODNear) ? LODNearLayer : LODFarLayer;
+		return layeredLODPassResources->getAttachmentLayerView(attachmentIndex, layer);
+	}
 
-	VkExtent2D swapExtent = context.swapchain.extent;
-	VkViewport viewport = VkViewport{ 0.0f, 0.0f, static_cast<float>(swapExtent.width), static_cast<float>(swapExtent.height), hri::DefaultViewportMinDepth, hri::DefaultViewportMaxDepth };
-	VkRect2D scissor = VkRect2D{ VkOffset2D{0, 0}, swapExtent };
+	hri::RenderPassResourceManager& resourceManager = (mode == LODMode::LODNear) ? *hiDefLODPassResources : *loDefLODPassResources;
+	return resourceManager.getAttachmentResource(attachmentIndex).view;
+}
 
-	vkCmdSetViewport(frame.commandBuffer, 0, 1, &viewport);
-	vkCmdSetScissor(frame.commandBuffer, 0, 1, &scissor);
+void GBufferLayoutPass::recreateResources()
+{
+	// TODO: over-allocate the LOD layouts & Hi-Z like the compute targets, requires consumers to fetch by pixel or scale UVs
+	if (m_singlePassLOD)
+	{
+		layeredLODPassResources->recreateResources();
+	}
+	else
+	{
+		loDefLODPassResources->recreateResources();
+		hiDefLODPassResources->recreateResources();
+	}
 
-	vkCmdBindDescriptorSets(
-		frame.commandBuffer,
-		m_pPSO->bindPoint,
-		m_layout,
-		0, 1, &sceneDescriptorSet->set,
-		0, nullptr
-	);
+	destroyHiZResources();
+	createHiZResources();
+}
 
-	vkCmdBindPipeline(
-		frame.commandBuffer,
-		m_pPSO->bindPoint,
-		m_pPSO->pipeline
-	);
+void GBufferLayoutPass::createDrawBuffers(const SceneGraph& scene)
+{
+	m_meshCount = static_cast<uint32_t>(scene.meshes.size());
 
-	const auto instances = resources.activeScene->getRenderInstanceList();
-	const bool useNearLOD = (mode == LODMode::LODNear);
-	for (auto const& instance : instances)
+	// Each node draws a mesh at most once per pass, or once per LOD layer when rendering layered
+	std::vector<uint32_t> meshReferences(m_meshCount, 0);
+	for (auto const& node : scene.nodes)
 	{
-		// Get lod instance, lod mask, and mesh
-		uint32_t instanceId = (useNearLOD) ? instance.instanceIdLOD0 : instance.instanceIdLOD1;
-		uint32_t lodMask = SceneGraph::generateLODMask(instance);
-		const hri::Mesh& mesh = resources.activeScene->meshes[instanceId];
+		for (uint32_t lodIdx = 0; lodIdx < node.numLods; lodIdx++)
+		{
+			SceneNode::SceneId meshLOD = node.meshLODs[lodIdx];
+			bool counted = false;
+			for (uint32_t prevIdx = 0; prevIdx < lodIdx; prevIdx++)
+				counted |= (node.meshLODs[prevIdx] == meshLOD);
+
+			if (meshLOD != INVALID_SCENE_ID && !counted)
+				meshReferences[meshLOD]++;
+		}
+	}
 
-		// Set up push constants
-		PushConstantData pushConstants = PushConstantData{};
-		pushConstants.instanceId = instanceId;
-		pushConstants.lodMask = (useNearLOD) ? ((~lodMask) & VALID_MASK) : (lodMask & VALID_MASK);
-		pushConstants.modelMatrix = instance.modelMatrix;
+	// Reserve a range of draw instances for each draw command slot
+	const uint32_t drawsPerReference = m_singlePassLOD ? LODLayerCount : 1;
+	std::vector<VkDrawIndexedIndirectCommand> commands; commands.reserve(m_passCount * m_meshCount);
+	uint32_t firstInstance = 0;
+	for (uint32_t passIdx = 0; passIdx < m_passCount; passIdx++)
+	{
+		for (uint32_t meshIdx = 0; meshIdx < m_meshCount; meshIdx++)
+		{
+			const RenderInstanceData& instanceData = scene.getInstanceData(meshIdx);
+
+			VkDrawIndexedIndirectCommand command = VkDrawIndexedIndirectCommand{};
+			command.indexCount = instanceData.indexCount;
+			command.instanceCount = 0;
+			command.firstIndex = instanceData.firstIndex;
+			command.vertexOffset = instanceData.vertexOffset;
+			command.firstInstance = firstInstance;
+			commands.push_back(command);
+
+			firstInstance += meshReferences[meshIdx] * drawsPerReference;
+		}
+	}
 
-		vkCmdPushConstants(
-			frame.commandBuffer,
-			m_layout,
-			VK_SHADER_STAGE_VERTEX_BIT
-			| VK_SHADER_STAGE_FRAGMENT_BIT,
-			0, sizeof(GBufferLayoutPass::PushConstantData),
-			&pushConstants
-		);
+	size_t commandSize = hri::max<size_t>(commands.size(), 1) * sizeof(VkDrawIndexedIndirectCommand);
+	size_t drawInstanceSize = hri::max<uint32_t>(firstInstance, 1) * sizeof(DrawInstanceData);
 
-		VkDeviceSize offsets[] = {0};
-		vkCmdBindVertexBuffers(frame.commandBuffer, 0, 1, &mesh.vertexBuffer.buffer, offsets);
-		vkCmdBindIndexBuffer(frame.commandBuffer, mesh.indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
-		vkCmdDrawIndexed(frame.commandBuffer, mesh.indexCount, 1, 0, 0, 0);
-	}
+	drawCommandTemplates = std::unique_ptr<hri::BufferResource>(new hri::BufferResource(context, commandSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true));
+	drawCommandSSBO = std::unique_ptr<hri::BufferResource>(new hri::BufferResource(context, commandSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT));
+	visibleDrawCommandSSBO = std::unique_ptr<hri::BufferResource>(new hri::BufferResource(context, commandSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT));
+	drawCountSSBO = std::unique_ptr<hri::BufferResource>(new hri::BufferResource(context, m_passCount * sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT));
+	drawInstanceSSBO = std::unique_ptr<hri::BufferResource>(new hri::BufferResource(context, drawInstanceSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
 
-	resourceManager.endRenderPass(frame);
-	debug.cmdEndLabel(frame.commandBuffer);
+	if (!commands.empty())
+		drawCommandTemplates->copyToBuffer(commands.data(), commands.size() * sizeof(VkDrawIndexedIndirectCommand));
 }
 
-// --- GBUFFER SAMPLER PASS ---
-
-GBufferSamplePass::GBufferSamplePass(hri::RenderContext& context, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator)
-	:
-	IRenderPass(context)
+void GBufferLayoutPass::createHiZResources()
 {
-	// Set up input sampler
-	passInputSampler = std::unique_ptr<hri::ImageSampler>(new hri::ImageSampler(context));
-
-	// Set up descriptor sets
-	hri::DescriptorSetLayoutBuilder rngDescriptorSetLayoutBuilder(context);
-	rngDescriptorSetLayoutBuilder
-		.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+	// Mip 0 matches the G-buffer resolution, following mips halve it down to a single texel
+	VkExtent2D resolution = context.swapchain.extent;
+	m_hiZMipCount = 0;
+	for (uint32_t size = hri::max(resolution.width, resolution.height); size > 0; size >>= 1)
+		m_hiZMipCount++;
 
-	hri::DescriptorSetLayoutBuilder gbufferSampleDescriptorSetLayoutBuilder(context);
-	gbufferSampleDescriptorSetLayoutBuilder
-		.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-		.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-		.addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-		.addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-		.addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-		.addBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
-		.addBinding(6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+	m_hiZMipCount = hri::min<uint32_t>(m_hiZMipCount, DEMO_HIZ_MAX_MIP_COUNT);
+	m_hiZValid = false;
 
-	rngDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(rngDescriptorSetLayoutBuilder.build());
-	gbufferSampleDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(gbufferSampleDescriptorSetLayoutBuilder.build());
+	hiZPyramid = std::unique_ptr<hri::ImageResource>(new hri::ImageResource(
+		context,
+		VK_IMAGE_TYPE_2D,
+		VK_FORMAT_R32_SFLOAT,
+		VK_SAMPLE_COUNT_1_BIT,
+		VkExtent3D{ resolution.width, resolution.height, 1 },
+		m_hiZMipCount,
+		1,
+		VK_IMAGE_USAGE_STORAGE_BIT
+		| VK_IMAGE_USAGE_SAMPLED_BIT
+	));
 
-	rngDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *rngDescriptorSetLayout));
-	loDefDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *gbufferSampleDescriptorSetLayout));
-	hiDefDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *gbufferSampleDescriptorSetLayout));
+	hiZPyramid->createView(VK_IMAGE_VIEW_TYPE_2D, hri::ImageResource::DefaultComponentMapping(), hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, m_hiZMipCount, 0, 1));
 
-	// Set up render pass (almost the same as GBuffer layout)
+	m_hiZMipViews.resize(m_hiZMipCount, VK_NULL_HANDLE);
+	for (uint32_t mipLevel = 0; mipLevel < m_hiZMipCount; mipLevel++)
 	{
-		hri::RenderPassBuilder passBuilder(context);
-		passBuilder
+		VkImageViewCreateInfo viewCreateInfo = VkImageViewCreateInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+		viewCreateInfo.image = hiZPyramid->image;
+		viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewCreateInfo.format = hiZPyramid->format;
+		viewCreateInfo.components = hri::ImageResource::DefaultComponentMapping();
+		viewCreateInfo.subresourceRange = hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, 1, 0, 1);
+		HRI_VK_CHECK(vkCreateImageView(context.device, &viewCreateInfo, nullptr, &m_hiZMipViews[mipLevel]));
+	}
+
+	// Mip descriptor sets only reference resources owned by this pass, so they are written once per resolution
+	VkDescriptorImageInfo depthFarInfo = VkDescriptorImageInfo{};
+	depthFarInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	depthFarInfo.imageView = getLODAttachmentView(LODMode::LODFar, DepthAttachment);
+	depthFarInfo.sampler = nearestSampler->sampler;
+
+	VkDescriptorImageInfo depthNearInfo = VkDescriptorImageInfo{};
+	depthNearInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	depthNearInfo.imageView = getLODAttachmentView(LODMode::LODNear, DepthAttachment);
+	depthNearInfo.sampler = nearestSampler->sampler;
+
+	for (uint32_t mipLevel = 0; mipLevel < m_hiZMipCount; mipLevel++)
+	{
+		VkDescriptorImageInfo sourceInfo = VkDescriptorImageInfo{};
+		sourceInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		sourceInfo.imageView = m_hiZMipViews[mipLevel > 0 ? mipLevel - 1 : 0];
+		sourceInfo.sampler = VK_NULL_HANDLE;
+
+		VkDescriptorImageInfo destinationInfo = VkDescriptorImageInfo{};
+		destinationInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		destinationInfo.imageView = m_hiZMipViews[mipLevel];
+		destinationInfo.sampler = VK_NULL_HANDLE;
+
+		(*hiZDescriptorSets[mipLevel])
+			.writeImage(0, &depthFarInfo)
+			.writeImage(1, &depthNearInfo)
+			.writeImage(2, &sourceInfo)
+			.writeImage(3, &destinationInfo)
+			.flush();
+	}
+}
+
+void GBufferLayoutPass::destroyHiZResources()
+{
+	for (auto& view : m_hiZMipViews)
+	{
+		vkDestroyImageView(context.device, view, nullptr);
+	}
+
+	m_hiZMipViews.clear();
+}
+
+void GBufferLayoutPass::buildHiZ(hri::ActiveFrame& frame)
+{
+	debug.cmdBeginLabel(frame.commandBuffer, "GBuffer Hi-Z Build");
+
+	// Wait for depth writes, and for the previous phase's draws before their draw buffers are reset
+	VkMemoryBarrier2 depthBarrier = VkMemoryBarrier2{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+	depthBarrier.srcStageMask = VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT;
+	depthBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+	depthBarrier.srcAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	depthBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+	frame.pipelineBarrier({ depthBarrier });
+
+	vkCmdBindPipeline(frame.commandBuffer, m_pHiZPSO->bindPoint, m_pHiZPSO->pipeline);
+
+	VkExtent2D mipExtent = context.swapchain.extent;
+	for (uint32_t mipLevel = 0; mipLevel < m_hiZMipCount; mipLevel++)
+	{
+		HiZPushConstantData pushConstants = HiZPushConstantData{};
+		pushConstants.mipLevel = mipLevel;
+
+		vkCmdBindDescriptorSets(
+			frame.commandBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE,
+			m_hiZLayout,
+			0, 1, &hiZDescriptorSets[mipLevel]->set,
+			0, nullptr
+		);
+
+		vkCmdPushConstants(
+			frame.commandBuffer,
+			m_hiZLayout,
+			VK_SHADER_STAGE_COMPUTE_BIT,
+			0, sizeof(GBufferLayoutPass::HiZPushConstantData),
+			&pushConstants
+		);
+
+		vkCmdDispatch(frame.commandBuffer, tileGroupCount(mipExtent.width, DEMO_HIZ_GROUP_SIZE), tileGroupCount(mipExtent.height, DEMO_HIZ_GROUP_SIZE), 1);
+
+		VkMemoryBarrier2 mipBarrier = VkMemoryBarrier2{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+		mipBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		mipBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		mipBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+		mipBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+		frame.pipelineBarrier({ mipBarrier });
+
+		mipExtent.width = hri::max<uint32_t>(mipExtent.width / 2, 1);
+		mipExtent.height = hri::max<uint32_t>(mipExtent.height / 2, 1);
+	}
+
+	debug.cmdEndLabel(frame.commandBuffer);
+}
+
+void GBufferLayoutPass::executeCullPass(hri::ActiveFrame& frame, uint32_t phase)
+{
+	debug.cmdBeginLabel(frame.commandBuffer, phase == CullPhaseVisible ? "GBuffer Culling" : "GBuffer Occlusion Culling");
+
+	// Reset draw commands & the occluded draw list at the start of the frame, the occluded phase appends after the
+	// visible phase's draw instances (rebased by the compaction pass) so both phases' draw instances stay valid
+	if (phase == CullPhaseVisible)
+	{
+		VkBufferCopy commandCopy = VkBufferCopy{ 0, 0, drawCommandSSBO->bufferSize };
+		vkCmdCopyBuffer(frame.commandBuffer, drawCommandTemplates->buffer, drawCommandSSBO->buffer, 1, &commandCopy);
+		vkCmdFillBuffer(frame.commandBuffer, occludedDrawSSBO->buffer, 0, sizeof(uint32_t), 0);
+	}
+
+	vkCmdFillBuffer(frame.commandBuffer, drawCountSSBO->buffer, 0, VK_WHOLE_SIZE, 0);
+
+	VkMemoryBarrier2 resetBarrier = VkMemoryBarrier2{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+	resetBarrier.srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+	resetBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	resetBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+	resetBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+	frame.pipelineBarrier({ resetBarrier });
+
+	VkExtent2D resolution = context.swapchain.extent;
+	CullPushConstantData pushConstants = CullPushConstantData{};
+	pushConstants.instanceCount = m_renderInstanceCount;
+	pushConstants.meshCount = m_meshCount;
+	pushConstants.passCount = m_passCount;
+	pushConstants.phase = phase;
+	pushConstants.useOcclusion = (phase == CullPhaseOccluded || m_hiZValid) ? 1 : 0;
+	pushConstants.hiZMipCount = m_hiZMipCount;
+	pushConstants.hiZResolution = hri::Float2(static_cast<float>(resolution.width), static_cast<float>(resolution.height));
+
+	vkCmdBindDescriptorSets(
+		frame.commandBuffer,
+		VK_PIPELINE_BIND_POINT_COMPUTE,
+		m_cullLayout,
+		0, 1, &cullDescriptorSet->set,
+		0, nullptr
+	);
+
+	vkCmdPushConstants(
+		frame.commandBuffer,
+		m_cullLayout,
+		VK_SHADER_STAGE_COMPUTE_BIT,
+		0, sizeof(GBufferLayoutPass::CullPushConstantData),
+		&pushConstants
+	);
+
+	// Cull instances & select LODs, appending visible instances to their draw command
+	// The occluded phase runs a thread per possible occluded draw (near & far per instance)
+	uint32_t cullThreadCount = (phase == CullPhaseVisible) ? m_renderInstanceCount : 2 * m_renderInstanceCount;
+	vkCmdBindPipeline(frame.commandBuffer, m_pCullPSO->bindPoint, m_pCullPSO->pipeline);
+	vkCmdDispatch(frame.commandBuffer, tileGroupCount(cullThreadCount, DEMO_CULL_GROUP_SIZE), 1, 1);
+
+	VkMemoryBarrier2 cullBarrier = VkMemoryBarrier2{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+	cullBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	cullBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	cullBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+	cullBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+	frame.pipelineBarrier({ cullBarrier });
+
+	// Compact non empty draw commands & count draws per pass
+	vkCmdBindPipeline(frame.commandBuffer, m_pCompactPSO->bindPoint, m_pCompactPSO->pipeline);
+	vkCmdDispatch(frame.commandBuffer, tileGroupCount(m_passCount * m_meshCount, DEMO_CULL_GROUP_SIZE), 1, 1);
+
+	VkMemoryBarrier2 drawBarrier = VkMemoryBarrier2{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+	drawBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	drawBarrier.dstStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT;
+	drawBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+	drawBarrier.dstAccessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_SHADER_READ_BIT;
+	frame.pipelineBarrier({ drawBarrier });
+
+	debug.cmdEndLabel(frame.commandBuffer);
+}
+
+void GBufferLayoutPass::executeGBufferPass(hri::RenderPassResourceManager& resourceManager, hri::ActiveFrame& frame, CommonResources& resources, uint32_t passIndex, bool loadAttachments, const char* label)
+{
+	debug.cmdBeginLabel(frame.commandBuffer, label);
+	resourceManager.beginRenderPass(frame, loadAttachments ? m_loadRenderPass : resourceManager.renderPass());
+
+	VkExtent2D swapExtent = context.swapchain.extent;
+	VkViewport viewport = VkViewport{ 0.0f, 0.0f, static_cast<float>(swapExtent.width), static_cast<float>(swapExtent.height), hri::DefaultViewportMinDepth, hri::DefaultViewportMaxDepth };
+	VkRect2D scissor = VkRect2D{ VkOffset2D{0, 0}, swapExtent };
+
+	vkCmdSetViewport(frame.commandBuffer, 0, 1, &viewport);
+	vkCmdSetScissor(frame.commandBuffer, 0, 1, &scissor);
+
+	vkCmdBindDescriptorSets(
+		frame.commandBuffer,
+		m_pPSO->bindPoint,
+		m_layout,
+		0, 1, &sceneDescriptorSet->set,
+		0, nullptr
+	);
+
+	// All meshes share the scene geometry buffers, so a pass is a single indirect draw of its visible draw commands
+	const SceneBuffers& sceneBuffers = resources.activeScene->buffers;
+	VkDeviceSize offsets[] = {0};
+	vkCmdBindIndexBuffer(frame.commandBuffer, sceneBuffers.indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+
+	if (m_depthPrepass)
+	{
+		// Lay out depth first, the G-buffer subpass then only shades the closest fragment per pixel
+		vkCmdBindPipeline(frame.commandBuffer, m_pDepthPrepassPSO->bindPoint, m_pDepthPrepassPSO->pipeline);
+		vkCmdBindVertexBuffers(frame.commandBuffer, 0, 1, &sceneBuffers.positionBuffer.buffer, offsets);
+
+		vkCmdDrawIndexedIndirectCount(
+			frame.commandBuffer,
+			visibleDrawCommandSSBO->buffer, passIndex * m_meshCount * sizeof(VkDrawIndexedIndirectCommand),
+			drawCountSSBO->buffer, passIndex * sizeof(uint32_t),
+			m_meshCount, sizeof(VkDrawIndexedIndirectCommand)
+		);
+
+		vkCmdNextSubpass(frame.commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+	}
+
+	vkCmdBindPipeline(
+		frame.commandBuffer,
+		m_pPSO->bindPoint,
+		m_pPSO->pipeline
+	);
+
+	vkCmdBindVertexBuffers(frame.commandBuffer, 0, 1, &sceneBuffers.vertexBuffer.buffer, offsets);
+	vkCmdDrawIndexedIndirectCount(
+		frame.commandBuffer,
+		visibleDrawCommandSSBO->buffer, passIndex * m_meshCount * sizeof(VkDrawIndexedIndirectCommand),
+		drawCountSSBO->buffer, passIndex * sizeof(uint32_t),
+		m_meshCount, sizeof(VkDrawIndexedIndirectCommand)
+	);
+
+	resourceManager.endRenderPass(frame);
+	debug.cmdEndLabel(frame.commandBuffer);
+}
+
+void GBufferLayoutPass::executeResolvePass(hri::ActiveFrame& frame)
+{
+	debug.cmdBeginLabel(frame.commandBuffer, "GBuffer Visibility Resolve");
+
+	VkMemoryBarrier2 visibilityBarrier = VkMemoryBarrier2{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+	visibilityBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+	visibilityBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	visibilityBarrier.srcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+	visibilityBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
+	frame.pipelineBarrier({ visibilityBarrier });
+
+	vkCmdBindPipeline(frame.commandBuffer, m_pResolvePSO->bindPoint, m_pResolvePSO->pipeline);
+
+	VkExtent2D resolution = context.swapchain.extent;
+	for (uint32_t layer = 0; layer < LODLayerCount; layer++)
+	{
+		vkCmdBindDescriptorSets(
+			frame.commandBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE,
+			m_resolveLayout,
+			0, 1, &resolveDescriptorSets[layer]->set,
+			0, nullptr
+		);
+
+		vkCmdDispatch(frame.commandBuffer, tileGroupCount(resolution.width, DEMO_GBUFFER_RESOLVE_GROUP_SIZE), tileGroupCount(resolution.height, DEMO_GBUFFER_RESOLVE_GROUP_SIZE), 1);
+	}
+
+	// Transition the resolved targets to the layout expected by G-buffer consumers
+	std::vector<VkImageMemoryBarrier2> targetBarriers = {};
+	std::vector<hri::RenderPassResourceManager*> resourceManagers = m_singlePassLOD
+		? std::vector<hri::RenderPassResourceManager*>{ layeredLODPassResources.get() }
+		: std::vector<hri::RenderPassResourceManager*>{ loDefLODPassResources.get(), hiDefLODPassResources.get() };
+
+	for (auto const& pResourceManager : resourceManagers)
+	{
+		for (uint32_t targetIdx = 0; targetIdx < GBufferTargetCount; targetIdx++)
+		{
+			VkImageMemoryBarrier2 targetBarrier = VkImageMemoryBarrier2{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+			targetBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			targetBarrier.dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT
+				| VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR
+				| VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			targetBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+			targetBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+			targetBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			targetBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			targetBarrier.image = pResourceManager->getAttachmentResource(targetIdx).image;
+			targetBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+			targetBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			targetBarrier.subresourceRange = hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, VK_REMAINING_ARRAY_LAYERS);
+			targetBarriers.push_back(targetBarrier);
+		}
+	}
+
+	frame.pipelineBarrier(targetBarriers);
+	debug.cmdEndLabel(frame.commandBuffer);
+}
+
+// --- GBUFFER SAMPLER PASS ---
+
+GBufferSamplePass::GBufferSamplePass(
+	hri::RenderContext& context,
+	hri::ShaderDatabase& shaderDB,
+	hri::DescriptorSetAllocator& descriptorAllocator,
+	bool packedGBuffer,
+	bool deferredSubpass
+)
+	:
+	IRenderPass(context),
+	m_packedGBuffer(packedGBuffer),
+	m_deferredSubpass(deferredSubpass)
+{
+	assert(packedGBuffer == (DEMO_PACKED_GBUFFER == 1));
+
+	// Set up input sampler
+	passInputSampler = std::unique_ptr<hri::ImageSampler>(new hri::ImageSampler(context));
+
+	// Set up descriptor sets
+	hri::DescriptorSetLayoutBuilder gbufferSampleDescriptorSetLayoutBuilder(context);
+	gbufferSampleDescriptorSetLayoutBuilder
+		.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+		.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+		.addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+		.addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+		.addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+		.addBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+		.addBinding(6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+	gbufferSampleDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(gbufferSampleDescriptorSetLayoutBuilder.build());
+
+	loDefDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *gbufferSampleDescriptorSetLayout));
+	hiDefDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *gbufferSampleDescriptorSetLayout));
+
+	if (m_deferredSubpass)
+	{
+		hri::DescriptorSetLayoutBuilder shadingDescriptorSetLayoutBuilder(context);
+		shadingDescriptorSetLayoutBuilder
+			.addBinding(0, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.addBinding(1, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.addBinding(2, VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+
+		shadingDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(shadingDescriptorSetLayoutBuilder.build());
+		shadingDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *shadingDescriptorSetLayout));
+	}
+
+	// Set up render pass (almost the same as GBuffer layout)
+	{
+		// Sampled targets are decoded, packed mode only uses smaller formats
+		const VkFormat albedoFormat = m_packedGBuffer ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_SNORM;
+		const VkFormat targetFormat = m_packedGBuffer ? VK_FORMAT_R16G16B16A16_SFLOAT : VK_FORMAT_R32G32B32A32_SFLOAT;
+
+		// With a shading subpass material targets are only read on-tile, so they are transient & never stored.
+		//	Normal & depth are still stored for temporal reprojection.
+		const VkAttachmentStoreOp materialStoreOp = m_deferredSubpass ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE;
+		const VkImageUsageFlags materialUsage = m_deferredSubpass
+			? VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT
+			: VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		const VkImageUsageFlags depthUsage = m_deferredSubpass
+			? VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+			: VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+		hri::RenderPassBuilder passBuilder(context);
+		passBuilder
 			.addAttachment( // Albedo target
-				VK_FORMAT_R8G8B8A8_SNORM, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
+				albedoFormat, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ATTACHMENT_LOAD_OP_CLEAR, materialStoreOp
 			)
 			.addAttachment( // Emission target
-				VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
+				targetFormat, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ATTACHMENT_LOAD_OP_CLEAR, materialStoreOp
 			)
 			.addAttachment( // Specular target
-				VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
+				targetFormat, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ATTACHMENT_LOAD_OP_CLEAR, materialStoreOp
 			)
 			.addAttachment( // Transmittance target
-				VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
+				targetFormat, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ATTACHMENT_LOAD_OP_CLEAR, materialStoreOp
 			)
 			.addAttachment( // Normal target
-				VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				targetFormat, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
 				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
 			)
 			.addAttachment( // Depth target
 				VK_FORMAT_R32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
 				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
 			)
+			.addAttachment( // Velocity target
+				VK_FORMAT_R16G16_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
+			)
 			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
 			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
 			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
 			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 3, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
 			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 4, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
-			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 5, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 5, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
+			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ VelocityAttachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
 
 		// Attachment configs
 		std::vector<hri::RenderAttachmentConfig> attachmentConfigs = {
-			hri::RenderAttachmentConfig{ VK_FORMAT_R8G8B8A8_SNORM, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
-			hri::RenderAttachmentConfig{ VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
-			hri::RenderAttachmentConfig{ VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
-			hri::RenderAttachmentConfig{ VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
-			hri::RenderAttachmentConfig{ VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
-			hri::RenderAttachmentConfig{ VK_FORMAT_R32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
+			hri::RenderAttachmentConfig{ albedoFormat, VK_SAMPLE_COUNT_1_BIT, materialUsage, VK_IMAGE_ASPECT_COLOR_BIT },
+			hri::RenderAttachmentConfig{ targetFormat, VK_SAMPLE_COUNT_1_BIT, materialUsage, VK_IMAGE_ASPECT_COLOR_BIT },
+			hri::RenderAttachmentConfig{ targetFormat, VK_SAMPLE_COUNT_1_BIT, materialUsage, VK_IMAGE_ASPECT_COLOR_BIT },
+			hri::RenderAttachmentConfig{ targetFormat, VK_SAMPLE_COUNT_1_BIT, materialUsage, VK_IMAGE_ASPECT_COLOR_BIT },
+			hri::RenderAttachmentConfig{ targetFormat, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
+			hri::RenderAttachmentConfig{ VK_FORMAT_R32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, depthUsage, VK_IMAGE_ASPECT_COLOR_BIT },
+			hri::RenderAttachmentConfig{ VK_FORMAT_R16G16_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
 		};
 
+		// Shading subpass reads albedo, emission & depth as input attachments & writes the shading result
+		if (m_deferredSubpass)
+		{
+			passBuilder
+				.addAttachment( // Shading result
+					VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+					VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
+				)
+				.nextSubpass()
+				.setAttachmentReference(hri::AttachmentType::Input, VkAttachmentReference{ 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL })
+				.setAttachmentReference(hri::AttachmentType::Input, VkAttachmentReference{ 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL })
+				.setAttachmentReference(hri::AttachmentType::Input, VkAttachmentReference{ 5, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL })
+				.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ ShadingResultAttachment, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL })
+				.addDependency(
+					SampleSubpass, ShadingSubpass,
+					VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+					VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_INPUT_ATTACHMENT_READ_BIT,
+					VK_DEPENDENCY_BY_REGION_BIT
+				);
+
+			attachmentConfigs.push_back(hri::RenderAttachmentConfig{ VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT });
+		}
+
 		passResources = std::make_unique<hri::RenderPassResourceManager>(context, passBuilder.build(), attachmentConfigs);
 		passResources->setClearValue(0, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
 		passResources->setClearValue(1, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
@@ -782,20 +1660,23 @@ GBufferSamplePass::GBufferSamplePass(hri::RenderContext& context, hri::ShaderDat
 		passResources->setClearValue(3, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
 		passResources->setClearValue(4, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
 		passResources->setClearValue(5, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
+		passResources->setClearValue(VelocityAttachment, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
+
+		if (m_deferredSubpass)
+			passResources->setClearValue(ShadingResultAttachment, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
 	}
 
 	// Set up render pipeline
 	{
 		hri::PipelineLayoutBuilder layoutBuilder(context);
 		m_layout = layoutBuilder
-			.addPushConstant(sizeof(GBufferSamplePass), VK_SHADER_STAGE_FRAGMENT_BIT)
-			.addDescriptorSetLayout(*rngDescriptorSetLayout)
+			.addPushConstant(sizeof(GBufferSamplePass::PushConstantData), VK_SHADER_STAGE_FRAGMENT_BIT)
 			.addDescriptorSetLayout(*gbufferSampleDescriptorSetLayout)
 			.addDescriptorSetLayout(*gbufferSampleDescriptorSetLayout)
 			.build();
 
-		shaderDB.registerShader("FullscreenQuadVert", hri::Shader::loadFile(context, "shaders/fullscreen_quad.vert.spv", VK_SHADER_STAGE_VERTEX_BIT));
-		shaderDB.registerShader("GBufferSampleFrag", hri::Shader::loadFile(context, "shaders/gbuffer_sample.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT));
+		shaderDB.registerShader("FullscreenQuadVert", "fullscreen_quad.vert");
+		shaderDB.registerShader("GBufferSampleFrag", "gbuffer_sample.frag");
 
 		VkExtent2D swapExtent = context.swapchain.extent;
 		std::vector<VkPipelineColorBlendAttachmentState> blendAttachments = {
@@ -877,6 +1758,19 @@ GBufferSamplePass::GBufferSamplePass(hri::RenderContext& context, hri::ShaderDat
 				| VK_COLOR_COMPONENT_B_BIT
 				| VK_COLOR_COMPONENT_A_BIT
 			},
+			VkPipelineColorBlendAttachmentState{
+				false,
+				VK_BLEND_FACTOR_ONE,
+				VK_BLEND_FACTOR_ZERO,
+				VK_BLEND_OP_ADD,
+				VK_BLEND_FACTOR_ONE,
+				VK_BLEND_FACTOR_ZERO,
+				VK_BLEND_OP_ADD,
+				VK_COLOR_COMPONENT_R_BIT
+				| VK_COLOR_COMPONENT_G_BIT
+				| VK_COLOR_COMPONENT_B_BIT
+				| VK_COLOR_COMPONENT_A_BIT
+			},
 		};
 
 		hri::GraphicsPipelineBuilder pipelineBuilder = hri::GraphicsPipelineBuilder{};
@@ -892,22 +1786,69 @@ GBufferSamplePass::GBufferSamplePass(hri::RenderContext& context, hri::ShaderDat
 		pipelineBuilder.dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
 		pipelineBuilder.layout = m_layout;
 		pipelineBuilder.renderPass = passResources->renderPass();
-		pipelineBuilder.subpass = 0;
+		pipelineBuilder.subpass = SampleSubpass;
+
+		m_pPSO = createLinkedGraphicsPipeline(shaderDB, "GBufferSamplePipeline", "FullscreenQuadVertexInputLibrary", "FullscreenQuadVert", "GBufferSampleFrag", pipelineBuilder);
+
+		if (m_deferredSubpass)
+		{
+			hri::PipelineLayoutBuilder shadingLayoutBuilder(context);
+			m_shadingLayout = shadingLayoutBuilder
+				.addDescriptorSetLayout(*shadingDescriptorSetLayout)
+				.build();
 
-		m_pPSO = shaderDB.createPipeline("GBufferSamplePipeline", { "FullscreenQuadVert", "GBufferSampleFrag" }, pipelineBuilder);
+			shaderDB.registerShader("DeferredSubpassFrag", "deferred_shading_subpass.frag");
+
+			std::vector<VkPipelineColorBlendAttachmentState> shadingBlendAttachments = { blendAttachments[0] };
+			pipelineBuilder.colorBlendState = hri::GraphicsPipelineBuilder::initColorBlendState(shadingBlendAttachments);
+			pipelineBuilder.layout = m_shadingLayout;
+			pipelineBuilder.subpass = ShadingSubpass;
+
+			m_pShadingPSO = createLinkedGraphicsPipeline(shaderDB, "DeferredSubpassShadingPipeline", "FullscreenQuadVertexInputLibrary", "FullscreenQuadVert", "DeferredSubpassFrag", pipelineBuilder);
+		}
 	}
 }
 
 GBufferSamplePass::~GBufferSamplePass()
 {
+	vkDestroyPipelineLayout(context.device, m_shadingLayout, nullptr);
 	vkDestroyPipelineLayout(context.device, m_layout, nullptr);
 }
 
+void GBufferSamplePass::prepareFrame(CommonResources& resources)
+{
+	if (!m_deferredSubpass)
+		return;
+
+	// Input attachment views change when pass resources are recreated
+	VkDescriptorImageInfo albedoInfo = VkDescriptorImageInfo{ VK_NULL_HANDLE, passResources->getAttachmentResource(0).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+	VkDescriptorImageInfo emissionInfo = VkDescriptorImageInfo{ VK_NULL_HANDLE, passResources->getAttachmentResource(1).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+	VkDescriptorImageInfo depthInfo = VkDescriptorImageInfo{ VK_NULL_HANDLE, passResources->getAttachmentResource(5).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+	(*shadingDescriptorSet)
+		.writeImage(0, &albedoInfo)
+		.writeImage(1, &emissionInfo)
+		.writeImage(2, &depthInfo)
+		.flush();
+}
+
 void GBufferSamplePass::drawFrame(hri::ActiveFrame& frame, CommonResources& resources)
 {
 	debug.resetTimer();
 	debug.cmdBeginLabel(frame.commandBuffer, "GBuffer Sample Pass");
 	debug.cmdRecordStartTimestamp(frame.commandBuffer);
+
+	if (m_deferredSubpass)
+	{
+		// Direct Illumination is written by the ray tracing pass right before this pass
+		VkMemoryBarrier2 inputBarrier = VkMemoryBarrier2{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+		inputBarrier.srcStageMask = VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR;
+		inputBarrier.dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+		inputBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+		inputBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+		frame.pipelineBarrier({ inputBarrier });
+	}
+
 	passResources->beginRenderPass(frame);
 
 	VkExtent2D swapExtent = context.swapchain.extent;
@@ -917,17 +1858,18 @@ void GBufferSamplePass::drawFrame(hri::ActiveFrame& frame, CommonResources& reso
 	vkCmdSetViewport(frame.commandBuffer, 0, 1, &viewport);
 	vkCmdSetScissor(frame.commandBuffer, 0, 1, &scissor);
 
-	VkDescriptorSet sets[] = { rngDescriptorSet->set, loDefDescriptorSet->set, hiDefDescriptorSet->set, };
+	VkDescriptorSet sets[] = { loDefDescriptorSet->set, hiDefDescriptorSet->set, };
 	vkCmdBindDescriptorSets(
 		frame.commandBuffer,
 		m_pPSO->bindPoint,
 		m_layout,
-		0, 3, sets,
+		0, HRI_SIZEOF_ARRAY(sets), sets,
 		0, nullptr
 	);
 
 	PushConstantData pushConstants = PushConstantData{};
 	pushConstants.resolution = hri::Float2((float)swapExtent.width, (float)swapExtent.height);
+	pushConstants.frameIndex = resources.frameIndex;
 
 	vkCmdPushConstants(
 		frame.commandBuffer,
@@ -945,6 +1887,22 @@ void GBufferSamplePass::drawFrame(hri::ActiveFrame& frame, CommonResources& reso
 
 	vkCmdDraw(frame.commandBuffer, 3, 1, 0, 0);
 
+	if (m_deferredSubpass)
+	{
+		vkCmdNextSubpass(frame.commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+
+		vkCmdBindDescriptorSets(
+			frame.commandBuffer,
+			m_pShadingPSO->bindPoint,
+			m_shadingLayout,
+			0, 1, &shadingDescriptorSet->set,
+			0, nullptr
+		);
+
+		vkCmdBindPipeline(frame.commandBuffer, m_pShadingPSO->bindPoint, m_pShadingPSO->pipeline);
+		vkCmdDraw(frame.commandBuffer, 3, 1, 0, 0);
+	}
+
 	passResources->endRenderPass(frame);
 	debug.cmdRecordEndTimestamp(frame.commandBuffer);
 	debug.cmdEndLabel(frame.commandBuffer);
@@ -959,17 +1917,18 @@ void GBufferSamplePass::drawFrame(hri::ActiveFrame& frame, CommonResources& reso
 
 // --- DIRECT ILLUMINATION PASS ---
 
-DirectIlluminationPass::DirectIlluminationPass(raytracing::RayTracingContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator)
+DirectIlluminationPass::DirectIlluminationPass(raytracing::RayTracingContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator, bool sampleLODGBuffers)
 	:
 	IRenderPass(ctx.renderContext),
-	rtContext(ctx)
+	rtContext(ctx),
+	m_sampleLODGBuffers(sampleLODGBuffers)
 {
 	recreateResources(context.swapchain.extent);
 
 	// Create sampler
 	passInputSampler = std::unique_ptr<hri::ImageSampler>(new hri::ImageSampler(context));
 	
-	// Create descriptor set layouts & sets
+	// Create descriptor set layouts & sets, LOD layouts have an additional LOD mask target
 	hri::DescriptorSetLayoutBuilder gbufferDataDescriptorSetLayoutBuilder(context);
 	gbufferDataDescriptorSetLayoutBuilder
 		.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
@@ -977,8 +1936,10 @@ DirectIlluminationPass::DirectIlluminationPass(raytracing::RayTracingContext& ct
 		.addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
 		.addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
 		.addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
-		.addBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_RAYGEN_BIT_KHR)
-		.addBinding(6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_RAYGEN_BIT_KHR);
+		.addBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_RAYGEN_BIT_KHR);
+
+	if (m_sampleLODGBuffers)
+		gbufferDataDescriptorSetLayoutBuilder.addBinding(6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_RAYGEN_BIT_KHR);
 
 	hri::DescriptorSetLayoutBuilder rtDescriptorSetLayoutBuilder(context);
 	rtDescriptorSetLayoutBuilder
@@ -991,28 +1952,45 @@ DirectIlluminationPass::DirectIlluminationPass(raytracing::RayTracingContext& ct
 	gbufferDataDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(gbufferDataDescriptorSetLayoutBuilder.build());
 	rtDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(rtDescriptorSetLayoutBuilder.build());
 
-	gbufferDataDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *gbufferDataDescriptorSetLayout));
 	rtDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *rtDescriptorSetLayout));
+	if (m_sampleLODGBuffers)
+	{
+		loDefDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *gbufferDataDescriptorSetLayout));
+		hiDefDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *gbufferDataDescriptorSetLayout));
+	}
+	else
+	{
+		gbufferDataDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *gbufferDataDescriptorSetLayout));
+	}
 
-	// Create pipeline & SBT
+	// Create pipeline & SBT, the near LOD layout set comes after the ray tracing set so hit & miss shaders are shared
 	hri::PipelineLayoutBuilder layoutBuilder(context);
-	m_layout = layoutBuilder
+	layoutBuilder
+		.addPushConstant(sizeof(DirectIlluminationPass::PushConstantData), VK_SHADER_STAGE_RAYGEN_BIT_KHR)
 		.addDescriptorSetLayout(*gbufferDataDescriptorSetLayout)
-		.addDescriptorSetLayout(*rtDescriptorSetLayout)
-		.build();
+		.addDescriptorSetLayout(*rtDescriptorSetLayout);
+
+	if (m_sampleLODGBuffers)
+		layoutBuilder.addDescriptorSetLayout(*gbufferDataDescriptorSetLayout);
+
+	m_layout = layoutBuilder.build();
 
-	hri::Shader* pRayGen = shaderDB.registerShader("DIRayGen", hri::Shader::loadFile(context, "shaders/di.rgen.spv", VK_SHADER_STAGE_RAYGEN_BIT_KHR));
-	hri::Shader* pMiss = shaderDB.registerShader("DIMiss", hri::Shader::loadFile(context, "shaders/di.rmiss.spv", VK_SHADER_STAGE_MISS_BIT_KHR));
-	hri::Shader* pCHit = shaderDB.registerShader("DICHit", hri::Shader::loadFile(context, "shaders/di.rchit.spv", VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR));
+	hri::Shader* pRayGen = m_sampleLODGBuffers ? shaderDB.registerShader("DILODRayGen", "di_lod.rgen") : shaderDB.registerShader("DIRayGen", "di.rgen");
+	hri::Shader* pMiss = shaderDB.registerShader("DIMiss", "di.rmiss");
+	hri::Shader* pCHit = shaderDB.registerShader("DICHit", "di.rchit");
+
+	// Shader groups are compiled once into libraries, the pass pipeline only links them
+	const std::string libraryPrefix = m_sampleLODGBuffers ? "DILOD" : "DI";
+	m_rayGenLibrary = createRayTracingGroupLibrary(rtContext, shaderDB, libraryPrefix + "RayGenLibrary", m_layout, VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR, { pRayGen });
+	m_missLibrary = createRayTracingGroupLibrary(rtContext, shaderDB, libraryPrefix + "MissLibrary", m_layout, VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR, { pMiss });
+	m_hitLibrary = createRayTracingGroupLibrary(rtContext, shaderDB, libraryPrefix + "HitLibrary", m_layout, VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR, { pCHit });
 
 	raytracing::RayTracingPipelineBuilder pipelineBuilder(rtContext);
 	pipelineBuilder
-		.addShaderStage(pRayGen->stage, pRayGen->module)
-		.addShaderStage(pMiss->stage, pMiss->module)
-		.addShaderStage(pCHit->stage, pCHit->module)
-		.addRayTracingShaderGroup(VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR, 0)
-		.addRayTracingShaderGroup(VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR, 1)
-		.addRayTracingShaderGroup(VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR, VK_SHADER_UNUSED_KHR, 2)
+		.addLibrary(m_rayGenLibrary)
+		.addLibrary(m_missLibrary)
+		.addLibrary(m_hitLibrary)
+		.setLibraryInterface()
 		.setMaxRecursionDepth()
 		.setLayout(m_layout);
 
@@ -1084,15 +2062,40 @@ void DirectIlluminationPass::drawFrame(hri::ActiveFrame& frame, CommonResources&
 	VkStridedDeviceAddressRegionKHR hit = m_SBT->getRegion(raytracing::ShaderBindingTable::SGHit);
 	VkStridedDeviceAddressRegionKHR call = m_SBT->getRegion(raytracing::ShaderBindingTable::SGCall);
 
-	VkDescriptorSet sets[] = { gbufferDataDescriptorSet->set, rtDescriptorSet->set, };
-	vkCmdBindDescriptorSets(
+	PushConstantData pushConstants = PushConstantData{};
+	pushConstants.frameIdx = resources.frameIndex;
+
+	vkCmdPushConstants(
 		frame.commandBuffer,
-		m_pPSO->bindPoint,
 		m_layout,
-		0, HRI_SIZEOF_ARRAY(sets), sets,
-		0, nullptr
+		VK_SHADER_STAGE_RAYGEN_BIT_KHR,
+		0, sizeof(DirectIlluminationPass::PushConstantData),
+		&pushConstants
 	);
 
+	if (m_sampleLODGBuffers)
+	{
+		VkDescriptorSet sets[] = { loDefDescriptorSet->set, rtDescriptorSet->set, hiDefDescriptorSet->set, };
+		vkCmdBindDescriptorSets(
+			frame.commandBuffer,
+			m_pPSO->bindPoint,
+			m_layout,
+			0, HRI_SIZEOF_ARRAY(sets), sets,
+			0, nullptr
+		);
+	}
+	else
+	{
+		VkDescriptorSet sets[] = { gbufferDataDescriptorSet->set, rtDescriptorSet->set, };
+		vkCmdBindDescriptorSets(
+			frame.commandBuffer,
+			m_pPSO->bindPoint,
+			m_layout,
+			0, HRI_SIZEOF_ARRAY(sets), sets,
+			0, nullptr
+		);
+	}
+
 	vkCmdBindPipeline(
 		frame.commandBuffer,
 		m_pPSO->bindPoint,
@@ -1124,12 +2127,18 @@ void DirectIlluminationPass::drawFrame(hri::ActiveFrame& frame, CommonResources&
 
 void DirectIlluminationPass::recreateResources(VkExtent2D resolution)
 {
+	// Shading passes fetch the result by pixel, so it is over-allocated & only grows
+	if (resolution.width <= m_allocatedExtent.width && resolution.height <= m_allocatedExtent.height)
+		return;
+
+	m_allocatedExtent = hri::overallocateExtent(resolution, m_allocatedExtent);
+
 	renderResult = std::unique_ptr<hri::ImageResource>(new hri::ImageResource(
 		context,
 		VK_IMAGE_TYPE_2D,
 		VK_FORMAT_R32G32B32A32_SFLOAT,
 		VK_SAMPLE_COUNT_1_BIT,
-		{ resolution.width, resolution.height, 1 },
+		{ m_allocatedExtent.width, m_allocatedExtent.height, 1 },
 		1,
 		1,
 		VK_IMAGE_USAGE_STORAGE_BIT
@@ -1141,9 +2150,15 @@ void DirectIlluminationPass::recreateResources(VkExtent2D resolution)
 
 // --- DEFERRED SHADING PASS ---
 
-DeferredShadingPass::DeferredShadingPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator)
+DeferredShadingPass::DeferredShadingPass(
+	hri::RenderContext& ctx,
+	hri::ShaderDatabase& shaderDB,
+	hri::DescriptorSetAllocator& descriptorAllocator,
+	const hri::DescriptorSetLayout* lightListSetLayout
+)
 	:
-	IRenderPass(ctx)
+	IRenderPass(ctx),
+	m_tiledLights(lightListSetLayout != nullptr)
 {
 	// Set up input sampler
 	passInputSampler = std::unique_ptr<hri::ImageSampler>(new hri::ImageSampler(
@@ -1167,33 +2182,33 @@ DeferredShadingPass::DeferredShadingPass(hri::RenderContext& ctx, hri::ShaderDat
 	inputDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(inputDescriptorSetLayoutBuilder.build());
 	inputDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *inputDescriptorSetLayout));
 
-	// Set up render pass
+	// Set up dynamic rendering resources, no render pass or framebuffer is needed
 	{
-		hri::RenderPassBuilder passBuilder(ctx);
-		passBuilder
-			.addAttachment(
-				VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-				VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
-			)
-			.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+		std::vector<hri::DynamicRenderingAttachmentInfo> attachmentInfos = {
+			hri::DynamicRenderingAttachmentInfo{ hri::AttachmentType::Color, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL },
+		};
 
 		std::vector<hri::RenderAttachmentConfig> attachmentConfigs = {
 			hri::RenderAttachmentConfig{ VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_IMAGE_ASPECT_COLOR_BIT },
 		};
 
-		passResources = std::make_unique<hri::RenderPassResourceManager>(ctx, passBuilder.build(), attachmentConfigs);
+		passResources = std::make_unique<hri::DynamicRenderingResourceManager>(ctx, attachmentInfos, attachmentConfigs);
 		passResources->setClearValue(0, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
 	}
 
 	// Set up render pipeline
 	{
 		hri::PipelineLayoutBuilder layoutBuilder(context);
-		m_layout = layoutBuilder
-			.addDescriptorSetLayout(*inputDescriptorSetLayout)
-			.build();
+		layoutBuilder.addDescriptorSetLayout(*inputDescriptorSetLayout);
 
-		shaderDB.registerShader("FullscreenQuadVert", hri::Shader::loadFile(context, "shaders/fullscreen_quad.vert.spv", VK_SHADER_STAGE_VERTEX_BIT));
-		shaderDB.registerShader("DeferredFrag", hri::Shader::loadFile(context, "shaders/deferred_shading.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT));
+		if (m_tiledLights)
+			layoutBuilder.addDescriptorSetLayout(*lightListSetLayout);
+
+		m_layout = layoutBuilder.build();
+
+		shaderDB.registerShader("FullscreenQuadVert", "fullscreen_quad.vert");
+		shaderDB.registerShader("DeferredFrag", "deferred_shading.frag");
+		shaderDB.registerShader("DeferredTiledFrag", "deferred_shading_tiled.frag");
 
 		VkExtent2D swapExtent = context.swapchain.extent;
 		std::vector<VkPipelineColorBlendAttachmentState> blendAttachments = {
@@ -1224,10 +2239,14 @@ DeferredShadingPass::DeferredShadingPass(hri::RenderContext& ctx, hri::ShaderDat
 		pipelineBuilder.colorBlendState = hri::GraphicsPipelineBuilder::initColorBlendState(blendAttachments);
 		pipelineBuilder.dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
 		pipelineBuilder.layout = m_layout;
-		pipelineBuilder.renderPass = passResources->renderPass();
+		pipelineBuilder.renderPass = VK_NULL_HANDLE;
 		pipelineBuilder.subpass = 0;
+		pipelineBuilder.colorAttachmentFormats = { VK_FORMAT_R32G32B32A32_SFLOAT };
+		pipelineBuilder.depthAttachmentFormat = VK_FORMAT_UNDEFINED;
 
-		m_pPSO = shaderDB.createPipeline("DeferredShadingPipeline", { "FullscreenQuadVert", "DeferredFrag" }, pipelineBuilder);
+		m_pPSO = m_tiledLights
+			? createLinkedGraphicsPipeline(shaderDB, "DeferredShadingTiledPipeline", "FullscreenQuadVertexInputLibrary", "FullscreenQuadVert", "DeferredTiledFrag", pipelineBuilder)
+			: createLinkedGraphicsPipeline(shaderDB, "DeferredShadingPipeline", "FullscreenQuadVertexInputLibrary", "FullscreenQuadVert", "DeferredFrag", pipelineBuilder);
 	}
 }
 
@@ -1250,11 +2269,12 @@ void DeferredShadingPass::drawFrame(hri::ActiveFrame& frame, CommonResources& re
 	vkCmdSetViewport(frame.commandBuffer, 0, 1, &viewport);
 	vkCmdSetScissor(frame.commandBuffer, 0, 1, &scissor);
 
+	VkDescriptorSet sets[] = { inputDescriptorSet->set, lightListSet, };
 	vkCmdBindDescriptorSets(
 		frame.commandBuffer,
 		m_pPSO->bindPoint,
 		m_layout,
-		0, 1, &inputDescriptorSet->set,
+		0, m_tiledLights ? 2 : 1, sets,
 		0, nullptr
 	);
 
@@ -1273,27 +2293,364 @@ void DeferredShadingPass::drawFrame(hri::ActiveFrame& frame, CommonResources& re
 	frame.pipelineBarrier({ memoryBarrier });
 }
 
-// --- TEMPORAL REPROJECT PASS ---
+// --- GBUFFER SHADING PASS ---
 
-TemporalReprojectPass::TemporalReprojectPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator)
+GBufferShadingPass::GBufferShadingPass(
+	hri::RenderContext& ctx,
+	hri::ShaderDatabase& shaderDB,
+	hri::DescriptorSetAllocator& descriptorAllocator,
+	const hri::DescriptorSetLayout* lightListSetLayout
+)
+	:
+	IRenderPass(ctx),
+	m_tiledLights(lightListSetLayout != nullptr)
+{
+	recreateResources(context.swapchain.extent);
+
+	// Set up input sampler
+	passInputSampler = std::unique_ptr<hri::ImageSampler>(new hri::ImageSampler(
+		context,
+		VK_FILTER_NEAREST,
+		VK_FILTER_NEAREST,
+		VK_SAMPLER_MIPMAP_MODE_NEAREST
+	));
+
+	// Set up descriptor sets
+	hri::DescriptorSetLayoutBuilder gbufferSampleDescriptorSetLayoutBuilder(context);
+	gbufferSampleDescriptorSetLayoutBuilder
+		.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+		.addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+		.addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+		.addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+		.addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+		.addBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+		.addBinding(6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT);
+
+	hri::DescriptorSetLayoutBuilder shadingDescriptorSetLayoutBuilder(context);
+	shadingDescriptorSetLayoutBuilder
+		.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+		.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+		.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+		.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+		.addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT);
+
+	gbufferSampleDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(gbufferSampleDescriptorSetLayoutBuilder.build());
+	shadingDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(shadingDescriptorSetLayoutBuilder.build());
+
+	loDefDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *gbufferSampleDescriptorSetLayout));
+	hiDefDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *gbufferSampleDescriptorSetLayout));
+	shadingDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *shadingDescriptorSetLayout));
+
+	// Set up compute pipeline
+	hri::PipelineLayoutBuilder layoutBuilder(context);
+	layoutBuilder
+		.addPushConstant(sizeof(GBufferShadingPass::PushConstantData), VK_SHADER_STAGE_COMPUTE_BIT)
+		.addDescriptorSetLayout(*gbufferSampleDescriptorSetLayout)
+		.addDescriptorSetLayout(*gbufferSampleDescriptorSetLayout)
+		.addDescriptorSetLayout(*shadingDescriptorSetLayout);
+
+	if (m_tiledLights)
+		layoutBuilder.addDescriptorSetLayout(*lightListSetLayout);
+
+	m_layout = layoutBuilder.build();
+
+	if (m_tiledLights)
+	{
+		shaderDB.registerShader("GBufferShadingTiledCompute", "gbuffer_shading_tiled.comp");
+		m_pPSO = shaderDB.createPipeline("GBufferShadingTiledPipeline", "GBufferShadingTiledCompute", m_layout);
+	}
+	else
+	{
+		shaderDB.registerShader("GBufferShadingCompute", "gbuffer_shading.comp");
+		m_pPSO = shaderDB.createPipeline("GBufferShadingPipeline", "GBufferShadingCompute", m_layout);
+	}
+}
+
+GBufferShadingPass::~GBufferShadingPass()
+{
+	vkDestroyPipelineLayout(context.device, m_layout, nullptr);
+}
+
+void GBufferShadingPass::prepareFrame(CommonResources& resources)
+{
+	VkDescriptorImageInfo renderResultInfo = VkDescriptorImageInfo{ VK_NULL_HANDLE, renderResult->view, VK_IMAGE_LAYOUT_GENERAL };
+	VkDescriptorImageInfo renderNormalInfo = VkDescriptorImageInfo{ VK_NULL_HANDLE, renderNormal->view, VK_IMAGE_LAYOUT_GENERAL };
+	VkDescriptorImageInfo renderDepthInfo = VkDescriptorImageInfo{ VK_NULL_HANDLE, renderDepth->view, VK_IMAGE_LAYOUT_GENERAL };
+	VkDescriptorImageInfo renderVelocityInfo = VkDescriptorImageInfo{ VK_NULL_HANDLE, renderVelocity->view, VK_IMAGE_LAYOUT_GENERAL };
+
+	(*shadingDescriptorSet)
+		.writeImage(1, &renderResultInfo)
+		.writeImage(2, &renderNormalInfo)
+		.writeImage(3, &renderDepthInfo)
+		.writeImage(4, &renderVelocityInfo)
+		.flush();
+}
+
+void GBufferShadingPass::drawFrame(hri::ActiveFrame& frame, CommonResources& resources)
+{
+	debug.resetTimer();
+	debug.cmdBeginLabel(frame.commandBuffer, "GBuffer Shading Pass");
+	debug.cmdRecordStartTimestamp(frame.commandBuffer);
+
+	// Direct Illumination is written by the ray tracing pass right before this pass
+	VkMemoryBarrier2 inputBarrier = VkMemoryBarrier2{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+	inputBarrier.srcStageMask = VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR;
+	inputBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	inputBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+	inputBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+
+	VkImageMemoryBarrier2 resultBarrier = VkImageMemoryBarrier2{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+	resultBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	resultBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	resultBarrier.srcAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+	resultBarrier.dstAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+	resultBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	resultBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	resultBarrier.image = renderResult->image;
+	resultBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	resultBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	resultBarrier.subresourceRange = hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1);
+
+	VkImageMemoryBarrier2 normalBarrier = resultBarrier;
+	normalBarrier.image = renderNormal->image;
+
+	VkImageMemoryBarrier2 depthBarrier = resultBarrier;
+	depthBarrier.image = renderDepth->image;
+
+	VkImageMemoryBarrier2 velocityBarrier = resultBarrier;
+	velocityBarrier.image = renderVelocity->image;
+
+	frame.pipelineBarrier({ inputBarrier });
+	frame.pipelineBarrier({ resultBarrier, normalBarrier, depthBarrier, velocityBarrier });
+
+	VkExtent2D extent = context.swapchain.extent;
+	PushConstantData pushConstants = PushConstantData{};
+	pushConstants.resolution = hri::Float2((float)extent.width, (float)extent.height);
+	pushConstants.frameIndex = resources.frameIndex;
+
+	VkDescriptorSet sets[] = { loDefDescriptorSet->set, hiDefDescriptorSet->set, shadingDescriptorSet->set, lightListSet, };
+	vkCmdBindDescriptorSets(
+		frame.commandBuffer,
+		m_pPSO->bindPoint,
+		m_layout,
+		0, m_tiledLights ? HRI_SIZEOF_ARRAY(sets) : HRI_SIZEOF_ARRAY(sets) - 1, sets,
+		0, nullptr
+	);
+
+	vkCmdPushConstants(
+		frame.commandBuffer,
+		m_layout,
+		VK_SHADER_STAGE_COMPUTE_BIT,
+		0, sizeof(GBufferShadingPass::PushConstantData),
+		&pushConstants
+	);
+
+	vkCmdBindPipeline(frame.commandBuffer, m_pPSO->bindPoint, m_pPSO->pipeline);
+	vkCmdDispatch(
+		frame.commandBuffer,
+		tileGroupCount(extent.width, DEMO_GBUFFER_SHADING_GROUP_SIZE),
+		tileGroupCount(extent.height, DEMO_GBUFFER_SHADING_GROUP_SIZE),
+		1
+	);
+
+	// Outputs are sampled by the temporal reprojection pass
+	resultBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+	resultBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+	resultBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+	resultBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	normalBarrier = resultBarrier;
+	normalBarrier.image = renderNormal->image;
+
+	depthBarrier = resultBarrier;
+	depthBarrier.image = renderDepth->image;
+
+	velocityBarrier = resultBarrier;
+	velocityBarrier.image = renderVelocity->image;
+
+	frame.pipelineBarrier({ resultBarrier, normalBarrier, depthBarrier, velocityBarrier });
+
+	debug.cmdRecordEndTimestamp(frame.commandBuffer);
+	debug.cmdEndLabel(frame.commandBuffer);
+}
+
+void GBufferShadingPass::recreateResources(VkExtent2D resolution)
+{
+	// Temporal reprojection fetches the targets by pixel, so they are over-allocated & only grow
+	if (resolution.width <= m_allocatedExtent.width && resolution.height <= m_allocatedExtent.height)
+		return;
+
+	m_allocatedExtent = hri::overallocateExtent(resolution, m_allocatedExtent);
+
+	auto createTarget = [&](VkFormat format) {
+		std::unique_ptr<hri::ImageResource> target = std::unique_ptr<hri::ImageResource>(new hri::ImageResource(
+			context,
+			VK_IMAGE_TYPE_2D,
+			format,
+			VK_SAMPLE_COUNT_1_BIT,
+			{ m_allocatedExtent.width, m_allocatedExtent.height, 1 },
+			1,
+			1,
+			VK_IMAGE_USAGE_STORAGE_BIT
+			| VK_IMAGE_USAGE_SAMPLED_BIT
+		));
+
+		target->createView(VK_IMAGE_VIEW_TYPE_2D, hri::ImageResource::DefaultComponentMapping(), hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1));
+		return target;
+	};
+
+	renderResult = createTarget(VK_FORMAT_R32G32B32A32_SFLOAT);
+	renderNormal = createTarget(VK_FORMAT_R16G16B16A16_SFLOAT);
+	renderDepth = createTarget(VK_FORMAT_R32_SFLOAT);
+	renderVelocity = createTarget(VK_FORMAT_R16G16_SFLOAT);
+}
+
+// --- LIGHT CULLING PASS ---
+
+LightCullingPass::LightCullingPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator)
 	:
 	IRenderPass(ctx)
 {
 	recreateResources(context.swapchain.extent);
 
+	// The light list set is shared with the shading passes, so it is visible to both compute & fragment stages
+	hri::DescriptorSetLayoutBuilder lightListDescriptorSetLayoutBuilder(context);
+	lightListDescriptorSetLayoutBuilder
+		.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
+		.addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
+		.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+
+	lightListDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(lightListDescriptorSetLayoutBuilder.build());
+	lightListDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *lightListDescriptorSetLayout));
+
+	hri::PipelineLayoutBuilder layoutBuilder(context);
+	m_layout = layoutBuilder
+		.addPushConstant(sizeof(LightCullingPass::PushConstantData), VK_SHADER_STAGE_COMPUTE_BIT)
+		.addDescriptorSetLayout(*lightListDescriptorSetLayout)
+		.build();
+
+	shaderDB.registerShader("LightCullCompute", "light_cull.comp");
+	m_pPSO = shaderDB.createPipeline("LightCullPipeline", "LightCullCompute", m_layout);
+}
+
+LightCullingPass::~LightCullingPass()
+{
+	vkDestroyPipelineLayout(context.device, m_layout, nullptr);
+}
+
+void LightCullingPass::prepareFrame(CommonResources& resources)
+{
+	VkDescriptorBufferInfo cameraInfo = VkDescriptorBufferInfo{};
+	cameraInfo.buffer = resources.cameraUBO->buffer;
+	cameraInfo.offset = 0;
+	cameraInfo.range = resources.cameraUBO->bufferSize;
+
+	VkDescriptorBufferInfo lightInfo = VkDescriptorBufferInfo{};
+	lightInfo.buffer = resources.lightSSBO->buffer;
+	lightInfo.offset = 0;
+	lightInfo.range = resources.lightSSBO->bufferSize;
+
+	VkDescriptorBufferInfo tileLightInfo = VkDescriptorBufferInfo{};
+	tileLightInfo.buffer = tileLightSSBO->buffer;
+	tileLightInfo.offset = 0;
+	tileLightInfo.range = tileLightSSBO->bufferSize;
+
+	(*lightListDescriptorSet)
+		.writeBuffer(0, &cameraInfo)
+		.writeBuffer(1, &lightInfo)
+		.writeBuffer(2, &tileLightInfo)
+		.flush();
+}
+
+void LightCullingPass::drawFrame(hri::ActiveFrame& frame, CommonResources& resources)
+{
+	debug.resetTimer();
+	debug.cmdBeginLabel(frame.commandBuffer, "Light Culling Pass");
+	debug.cmdRecordStartTimestamp(frame.commandBuffer);
+
+	// Last frame's shading passes may still read the tile light lists
+	VkMemoryBarrier2 tileListBarrier = VkMemoryBarrier2{ VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+	tileListBarrier.srcStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	tileListBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	tileListBarrier.srcAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+	tileListBarrier.dstAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+	frame.pipelineBarrier({ tileListBarrier });
+
+	VkExtent2D extent = context.swapchain.extent;
+	PushConstantData pushConstants = PushConstantData{};
+	pushConstants.resolution = hri::Float2((float)extent.width, (float)extent.height);
+	pushConstants.lightCount = resources.lightCount;
+
+	vkCmdBindDescriptorSets(
+		frame.commandBuffer,
+		m_pPSO->bindPoint,
+		m_layout,
+		0, 1, &lightListDescriptorSet->set,
+		0, nullptr
+	);
+
+	vkCmdPushConstants(
+		frame.commandBuffer,
+		m_layout,
+		VK_SHADER_STAGE_COMPUTE_BIT,
+		0, sizeof(LightCullingPass::PushConstantData),
+		&pushConstants
+	);
+
+	// One workgroup per screen tile
+	vkCmdBindPipeline(frame.commandBuffer, m_pPSO->bindPoint, m_pPSO->pipeline);
+	vkCmdDispatch(frame.commandBuffer, tileGroupCount(extent.width, DEMO_LIGHT_TILE_SIZE), tileGroupCount(extent.height, DEMO_LIGHT_TILE_SIZE), 1);
+
+	tileListBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	tileListBarrier.dstStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+	tileListBarrier.srcAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT;
+	tileListBarrier.dstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+	frame.pipelineBarrier({ tileListBarrier });
+
+	debug.cmdRecordEndTimestamp(frame.commandBuffer);
+	debug.cmdEndLabel(frame.commandBuffer);
+}
+
+void LightCullingPass::recreateResources(VkExtent2D resolution)
+{
+	// Tiles are indexed by the swap extent's tile row width, so a buffer sized for a larger extent fits as well
+	if (resolution.width <= m_allocatedExtent.width && resolution.height <= m_allocatedExtent.height)
+		return;
+
+	m_allocatedExtent = hri::overallocateExtent(resolution, m_allocatedExtent);
+
+	// Tile info header (uvec4) followed by a light count & MAX_LIGHTS_PER_TILE indices per tile
+	size_t tileCount = static_cast<size_t>(tileGroupCount(m_allocatedExtent.width, DEMO_LIGHT_TILE_SIZE)) * tileGroupCount(m_allocatedExtent.height, DEMO_LIGHT_TILE_SIZE);
+
+	tileLightSSBO = std::unique_ptr<hri::BufferResource>(new hri::BufferResource(
+		context,
+		4 * sizeof(uint32_t) + tileCount * DEMO_LIGHT_TILE_STRIDE * sizeof(uint32_t),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+	));
+}
+
+// --- TEMPORAL REPROJECT PASS ---
+
+TemporalReprojectPass::TemporalReprojectPass(
+	hri::RenderContext& ctx,
+	hri::ShaderDatabase& shaderDB,
+	hri::DescriptorSetAllocator& descriptorAllocator,
+	hri::BindlessDescriptorSet& bindlessSet,
+	bool presentBlit
+)
+	:
+	IRenderPass(ctx),
+	m_bindlessSet(bindlessSet),
+	m_presentBlit(presentBlit)
+{
 	passInputSampler = std::unique_ptr<hri::ImageSampler>(new hri::ImageSampler(context, VK_FILTER_LINEAR, VK_FILTER_LINEAR));
+	recreateResources(context.swapchain.extent);
 
+	// History & pass input images are accessed through the bindless set, only camera data is bound per pass
 	hri::DescriptorSetLayoutBuilder inputDescriptorSetLayoutBuilder(context);
 	inputDescriptorSetLayoutBuilder
 		.addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
-		.addBinding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
-		.addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
-		.addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
-		.addBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
-		.addBinding(5, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
-		.addBinding(6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
-		.addBinding(7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
-		.addBinding(8, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT);
+		.addBinding(1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT);
 
 	inputDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(inputDescriptorSetLayoutBuilder.build());
 	inputDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *inputDescriptorSetLayout));
@@ -1302,10 +2659,11 @@ TemporalReprojectPass::TemporalReprojectPass(hri::RenderContext& ctx, hri::Shade
 	m_layout = layoutBuilder
 		.addPushConstant(sizeof(TemporalReprojectPass::PushConstantData), VK_SHADER_STAGE_COMPUTE_BIT)
 		.addDescriptorSetLayout(*inputDescriptorSetLayout)
+		.addDescriptorSetLayout(*m_bindlessSet.layout)
 		.build();
 
-	shaderDB.registerShader("TemporalReprojectCompute", hri::Shader::loadFile(context, "shaders/temporal_reproject.comp.spv", VK_SHADER_STAGE_COMPUTE_BIT));
-	m_pPSO = shaderDB.createPipeline("TemporalReprojectComputePipeline", "TemporalReprojectCompute", m_layout);
+	shaderDB.registerShader("TemporalReprojectCompute", "temporal_reproject.comp");
+	m_tiledPSOs = createTiledComputePipelines(shaderDB, "TemporalReprojectComputePipeline", "TemporalReprojectCompute", m_layout);
 }
 
 TemporalReprojectPass::~TemporalReprojectPass()
@@ -1325,33 +2683,9 @@ void TemporalReprojectPass::prepareFrame(CommonResources& resources)
 	prevCamInfo.offset = 0;
 	prevCamInfo.range = resources.prevCameraUBO->bufferSize;
 
-	VkDescriptorImageInfo prevFrameInfo = VkDescriptorImageInfo{};
-	prevFrameInfo.imageView = result[(activeFrame + 1) % 2]->view;
-	prevFrameInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-	prevFrameInfo.sampler = VK_NULL_HANDLE;
-
-	VkDescriptorImageInfo currFrameInfo = VkDescriptorImageInfo{};
-	currFrameInfo.imageView = result[activeFrame]->view;
-	currFrameInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-	currFrameInfo.sampler = VK_NULL_HANDLE;
-
-	VkDescriptorImageInfo normalHistoryInfo = VkDescriptorImageInfo{};
-	normalHistoryInfo.imageView = normalHistory->view;
-	normalHistoryInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-	normalHistoryInfo.sampler = VK_NULL_HANDLE;
-
-	VkDescriptorImageInfo reprojectInfo = VkDescriptorImageInfo{};
-	reprojectInfo.imageView = reprojectHistory->view;
-	reprojectInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-	reprojectInfo.sampler = VK_NULL_HANDLE;
-
 	(*inputDescriptorSet)
 		.writeBuffer(0, &currCamInfo)
 		.writeBuffer(1, &prevCamInfo)
-		.writeImage(2, &prevFrameInfo)
-		.writeImage(3, &currFrameInfo)
-		.writeImage(4, &normalHistoryInfo)
-		.writeImage(5, &reprojectInfo)
 		.flush();
 }
 
@@ -1365,6 +2699,14 @@ void TemporalReprojectPass::drawFrame(hri::ActiveFrame& frame, CommonResources&
 	PushConstantData pushConstant = PushConstantData{};
 	pushConstant.accumulate = resources.accumulate;
 	pushConstant.resolution = hri::Float2((float)extent.width, (float)extent.height);
+	pushConstant.previousFrameIndex = m_resultStorageIndices[(activeFrame + 1) % 2];
+	pushConstant.currentFrameIndex = m_resultStorageIndices[activeFrame];
+	pushConstant.previousNormalIndex = m_normalHistoryIndex;
+	pushConstant.reprojectHistoryIndex = m_reprojectHistoryIndex;
+	pushConstant.renderResultIndex = inputIndices.renderResult;
+	pushConstant.renderNormalIndex = inputIndices.renderNormal;
+	pushConstant.renderDepthIndex = inputIndices.renderDepth;
+	pushConstant.renderVelocityIndex = inputIndices.renderVelocity;
 
 	VkImageMemoryBarrier2 renderResultBarrier = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
 	renderResultBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR;
@@ -1397,21 +2739,23 @@ void TemporalReprojectPass::drawFrame(hri::ActiveFrame& frame, CommonResources&
 		&pushConstant
 	);
 
+	hri::PipelineStateObject* pPSO = m_tiledPSOs.at(tileSize);
+	VkDescriptorSet descriptorSets[] = { inputDescriptorSet->set, m_bindlessSet.set };
 	vkCmdBindDescriptorSets(
 		frame.commandBuffer,
-		m_pPSO->bindPoint,
+		pPSO->bindPoint,
 		m_layout,
-		0, 1, &inputDescriptorSet->set,
+		0, HRI_SIZEOF_ARRAY(descriptorSets), descriptorSets,
 		0, nullptr
 	);
 
 	vkCmdBindPipeline(
 		frame.commandBuffer,
-		m_pPSO->bindPoint,
-		m_pPSO->pipeline
+		pPSO->bindPoint,
+		pPSO->pipeline
 	);
 
-	vkCmdDispatch(frame.commandBuffer, extent.width, extent.height, 1);
+	vkCmdDispatch(frame.commandBuffer, tileGroupCount(extent.width, tileSize), tileGroupCount(extent.height, tileSize), 1);
 
 	renderResultBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR;
 	renderResultBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR;
@@ -1419,7 +2763,61 @@ void TemporalReprojectPass::drawFrame(hri::ActiveFrame& frame, CommonResources&
 	renderResultBarrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT;
 	renderResultBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
 	renderResultBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	frame.pipelineBarrier({ renderResultBarrier });
+
+	if (m_presentBlit)
+	{
+		// The swap image is sRGB, the blit encodes the linear result for display
+		assert(frame.activeSwapImageIndex < m_swapImages.size());
+
+		VkImageMemoryBarrier2 blitSourceBarrier = renderResultBarrier;
+		blitSourceBarrier.dstStageMask = VK_PIPELINE_STAGE_2_BLIT_BIT;
+		blitSourceBarrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+		blitSourceBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+		VkImageMemoryBarrier2 swapImageBarrier = VkImageMemoryBarrier2{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+		swapImageBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+		swapImageBarrier.dstStageMask = VK_PIPELINE_STAGE_2_BLIT_BIT;
+		swapImageBarrier.srcAccessMask = VK_ACCESS_2_NONE;
+		swapImageBarrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		swapImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		swapImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		swapImageBarrier.image = m_swapImages[frame.activeSwapImageIndex];
+		swapImageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		swapImageBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		swapImageBarrier.subresourceRange = hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1);
+		frame.pipelineBarrier({ blitSourceBarrier, swapImageBarrier });
+
+		VkImageBlit blitRegion = VkImageBlit{};
+		blitRegion.srcSubresource = VkImageSubresourceLayers{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		blitRegion.srcOffsets[1] = VkOffset3D{ static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1 };
+		blitRegion.dstSubresource = VkImageSubresourceLayers{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		blitRegion.dstOffsets[1] = VkOffset3D{ static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1 };
+
+		vkCmdBlitImage(
+			frame.commandBuffer,
+			result[activeFrame]->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			m_swapImages[frame.activeSwapImageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1, &blitRegion,
+			VK_FILTER_NEAREST
+		);
+
+		// The UI pass loads the swap image in the color attachment layout
+		renderResultBarrier.srcStageMask = VK_PIPELINE_STAGE_2_BLIT_BIT;
+		renderResultBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+		renderResultBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+		swapImageBarrier.srcStageMask = VK_PIPELINE_STAGE_2_BLIT_BIT;
+		swapImageBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+		swapImageBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+		swapImageBarrier.dstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+		swapImageBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		swapImageBarrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		frame.pipelineBarrier({ renderResultBarrier, swapImageBarrier });
+	}
+	else
+	{
+		frame.pipelineBarrier({ renderResultBarrier });
+	}
 
 	debug.cmdRecordEndTimestamp(frame.commandBuffer);
 	debug.cmdEndLabel(frame.commandBuffer);
@@ -1428,12 +2826,22 @@ void TemporalReprojectPass::drawFrame(hri::ActiveFrame& frame, CommonResources&
 
 void TemporalReprojectPass::recreateResources(VkExtent2D resolution)
 {
+	// Swap images are owned by the swapchain, only the handles are kept for blitting
+	if (m_presentBlit)
+		m_swapImages = context.swapchain.get_images().value();
+
+	// History & result images are only addressed by pixel within the swap extent, so they are over-allocated & only grow
+	if (resolution.width <= m_allocatedExtent.width && resolution.height <= m_allocatedExtent.height)
+		return;
+
+	m_allocatedExtent = hri::overallocateExtent(resolution, m_allocatedExtent);
+
 	normalHistory = std::unique_ptr<hri::ImageResource>(new hri::ImageResource(
 		context,
 		VK_IMAGE_TYPE_2D,
 		VK_FORMAT_R32G32B32A32_SFLOAT,
 		VK_SAMPLE_COUNT_1_BIT,
-		VkExtent3D{ resolution.width, resolution.height, 1 },
+		VkExtent3D{ m_allocatedExtent.width, m_allocatedExtent.height, 1 },
 		1,
 		1,
 		VK_IMAGE_USAGE_STORAGE_BIT
@@ -1444,7 +2852,7 @@ void TemporalReprojectPass::recreateResources(VkExtent2D resolution)
 		VK_IMAGE_TYPE_2D,
 		VK_FORMAT_R32G32_SFLOAT,
 		VK_SAMPLE_COUNT_1_BIT,
-		VkExtent3D{ resolution.width, resolution.height, 1 },
+		VkExtent3D{ m_allocatedExtent.width, m_allocatedExtent.height, 1 },
 		1,
 		1,
 		VK_IMAGE_USAGE_STORAGE_BIT
@@ -1461,59 +2869,59 @@ void TemporalReprojectPass::recreateResources(VkExtent2D resolution)
 			VK_IMAGE_TYPE_2D,
 			VK_FORMAT_R32G32B32A32_SFLOAT,
 			VK_SAMPLE_COUNT_1_BIT,
-			VkExtent3D{ resolution.width, resolution.height, 1 },
+			VkExtent3D{ m_allocatedExtent.width, m_allocatedExtent.height, 1 },
 			1,
 			1,
 			VK_IMAGE_USAGE_STORAGE_BIT
 			| VK_IMAGE_USAGE_SAMPLED_BIT
+			| (m_presentBlit ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0)
 		));
 
 		result[i]->createView(VK_IMAGE_VIEW_TYPE_2D, hri::ImageResource::DefaultComponentMapping(), hri::ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1));
 	}
+
+	// (Re)store history images in the bindless set, indices remain stable across resizes
+	auto storeImage = [&](hri::BindlessResourceType type, uint32_t& index, VkImageView view, VkImageLayout layout, VkSampler sampler) {
+		VkDescriptorImageInfo imageInfo = VkDescriptorImageInfo{ sampler, view, layout };
+		if (index == HRI_BINDLESS_INVALID_INDEX)
+			index = m_bindlessSet.storeImage(type, imageInfo);
+		else
+			m_bindlessSet.updateImage(type, index, imageInfo);
+	};
+
+	storeImage(hri::BindlessResourceType::StorageImage, m_normalHistoryIndex, normalHistory->view, VK_IMAGE_LAYOUT_GENERAL, VK_NULL_HANDLE);
+	storeImage(hri::BindlessResourceType::StorageImage, m_reprojectHistoryIndex, reprojectHistory->view, VK_IMAGE_LAYOUT_GENERAL, VK_NULL_HANDLE);
+	for (u32 i = 0; i < HRI_SIZEOF_ARRAY(result); i++)
+	{
+		storeImage(hri::BindlessResourceType::StorageImage, m_resultStorageIndices[i], result[i]->view, VK_IMAGE_LAYOUT_GENERAL, VK_NULL_HANDLE);
+		storeImage(hri::BindlessResourceType::SampledImage, m_resultSampledIndices[i], result[i]->view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, passInputSampler->sampler);
+	}
 }
 
 // --- PRESENT PASS ---
 
-PresentPass::PresentPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::DescriptorSetAllocator& descriptorAllocator)
+PresentPass::PresentPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB, hri::BindlessDescriptorSet& bindlessSet)
 	:
-	IRenderPass(ctx)
+	IRenderPass(ctx),
+	m_bindlessSet(bindlessSet)
 {
-	// Set up input sampler
-	passInputSampler = std::unique_ptr<hri::ImageSampler>(new hri::ImageSampler(
-		context,
-		VK_FILTER_LINEAR,
-		VK_FILTER_LINEAR,
-		VK_SAMPLER_MIPMAP_MODE_LINEAR
-	));
-
-	// Set up descriptor sets
-	hri::DescriptorSetLayoutBuilder presentDescriptorSetLayoutBuilder(context);
-	presentDescriptorSetLayoutBuilder
-		.addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
-
-	presentDescriptorSetLayout = std::make_unique<hri::DescriptorSetLayout>(presentDescriptorSetLayoutBuilder.build());
-	presentDescriptorSet = std::unique_ptr<hri::DescriptorSetManager>(new hri::DescriptorSetManager(context, descriptorAllocator, *presentDescriptorSetLayout));
-
-	// Set up render pass
-	hri::RenderPassBuilder passBuilder(ctx);
-	passBuilder
-		.addAttachment(
-			ctx.swapFormat(), VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-			VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE
-		)
-		.setAttachmentReference(hri::AttachmentType::Color, VkAttachmentReference{ 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL });
+	// Set up dynamic rendering resources, the UI pass loads the swap image in the color attachment layout
+	std::vector<hri::DynamicRenderingAttachmentInfo> attachmentInfos = {
+		hri::DynamicRenderingAttachmentInfo{ hri::AttachmentType::Color, VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_STORE, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL },
+	};
 
-	passResources = std::make_unique<hri::SwapchainPassResourceManager>(ctx, passBuilder.build());
+	passResources = std::make_unique<hri::DynamicRenderingResourceManager>(ctx, attachmentInfos, std::vector<hri::RenderAttachmentConfig>{}, true);
 	passResources->setClearValue(0, VkClearValue{ { 0.0f, 0.0f, 0.0f, 0.0f } });
 
 	// Set up render pipeline
 	hri::PipelineLayoutBuilder layoutBuilder(context);
 	m_layout = layoutBuilder
-		.addDescriptorSetLayout(*presentDescriptorSetLayout)
+		.addPushConstant(sizeof(PresentPass::PushConstantData), VK_SHADER_STAGE_FRAGMENT_BIT)
+		.addDescriptorSetLayout(*m_bindlessSet.layout)
 		.build();
 
-	shaderDB.registerShader("FullscreenQuadVert", hri::Shader::loadFile(context, "shaders/fullscreen_quad.vert.spv", VK_SHADER_STAGE_VERTEX_BIT));
-	shaderDB.registerShader("PresentFrag", hri::Shader::loadFile(context, "shaders/present.frag.spv", VK_SHADER_STAGE_FRAGMENT_BIT));
+	shaderDB.registerShader("FullscreenQuadVert", "fullscreen_quad.vert");
+	shaderDB.registerShader("PresentFrag", "present.frag");
 
 	VkExtent2D swapExtent = context.swapchain.extent;
 	std::vector<VkPipelineColorBlendAttachmentState> blendAttachments = {
@@ -1544,10 +2952,12 @@ PresentPass::PresentPass(hri::RenderContext& ctx, hri::ShaderDatabase& shaderDB,
 	pipelineBuilder.colorBlendState = hri::GraphicsPipelineBuilder::initColorBlendState(blendAttachments);
 	pipelineBuilder.dynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
 	pipelineBuilder.layout = m_layout;
-	pipelineBuilder.renderPass = passResources->renderPass();
+	pipelineBuilder.renderPass = VK_NULL_HANDLE;
 	pipelineBuilder.subpass = 0;
+	pipelineBuilder.colorAttachmentFormats = { ctx.swapFormat() };
+	pipelineBuilder.depthAttachmentFormat = VK_FORMAT_UNDEFINED;
 
-	m_pPSO = shaderDB.createPipeline("PresentPipeline", { "FullscreenQuadVert", "PresentFrag"}, pipelineBuilder);
+	m_pPSO = createLinkedGraphicsPipeline(shaderDB, "PresentPipeline", "FullscreenQuadVertexInputLibrary", "FullscreenQuadVert", "PresentFrag", pipelineBuilder);
 }
 
 PresentPass::~PresentPass()
@@ -1569,11 +2979,22 @@ void PresentPass::drawFrame(hri::ActiveFrame& frame, CommonResources& resources)
 	vkCmdSetViewport(frame.commandBuffer, 0, 1, &viewport);
 	vkCmdSetScissor(frame.commandBuffer, 0, 1, &scissor);
 
+	PushConstantData pushConstants = PushConstantData{};
+	pushConstants.renderResultIndex = renderResultIndex;
+
+	vkCmdPushConstants(
+		frame.commandBuffer,
+		m_layout,
+		VK_SHADER_STAGE_FRAGMENT_BIT,
+		0, sizeof(PresentPass::PushConstantData),
+		&pushConstants
+	);
+
 	vkCmdBindDescriptorSets(
 		frame.commandBuffer,
 		m_pPSO->bindPoint,
 		m_layout,
-		0, 1, &presentDescriptorSet->set,
+		0, 1, &m_bindlessSet.set,
 		0, nullptr
 	);
 
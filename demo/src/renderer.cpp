@@ -8,18 +8,36 @@
 
 #define SHOW_DEBUG_OUTPUT			1
 
+/// @brief Check if the swap images can be blitted into, blit support is not guaranteed for every surface format.
+/// @param ctx Render context to check the swapchain of.
+/// @return true if the swap image format supports blit destination use, false otherwise.
+static bool swapchainSupportsBlit(const hri::RenderContext& ctx)
+{
+	if ((ctx.swapchain.image_usage_flags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) == 0)
+		return false;
+
+	VkFormatProperties formatProperties = VkFormatProperties{};
+	vkGetPhysicalDeviceFormatProperties(ctx.gpu.physical_device, ctx.swapchain.image_format, &formatProperties);
+	return (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_DST_BIT) != 0;
+}
+
 Renderer::Renderer(raytracing::RayTracingContext& ctx, hri::Camera& camera, SceneGraph& activeScene)
 	:
 	m_context(ctx.renderContext),
 	m_raytracingContext(ctx),
 	m_renderCore(m_context),
-	m_shaderDatabase(m_context),
+	m_shaderDatabase(m_context, DEMO_SHADER_PACK_PATH),
 	m_descriptorSetAllocator(m_context),
+	m_bindlessDescriptorSet(m_context),
 	m_computePool(m_context, m_context.queues.computeQueue, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT),
 	m_stagingPool(m_context, m_context.queues.transferQueue, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT),
 	m_asBuildTimer(m_context),
 	m_accelerationStructureManager(ctx),
 	m_frameCounter(1),
+	m_fusedGBufferShading(DEMO_FUSED_GBUFFER_SHADING == 1),
+	m_subpassDeferredShading(DEMO_FUSED_GBUFFER_SHADING == 0 && DEMO_SUBPASS_DEFERRED_SHADING == 1),
+	m_temporalPresentBlit(DEMO_TEMPORAL_PRESENT_BLIT == 1 && swapchainSupportsBlit(m_context)),
+	m_tiledLightCulling(DEMO_TILED_LIGHT_CULLING == 1 && !(DEMO_FUSED_GBUFFER_SHADING == 0 && DEMO_SUBPASS_DEFERRED_SHADING == 1)),
 	m_prevCamera(camera),
 	m_camera(camera),
 	m_activeScene(activeScene)
@@ -54,19 +72,44 @@ void Renderer::setVSyncMode(hri::VSyncMode vsyncMode)
 void Renderer::prepareFrame()
 {
 	m_renderCore.awaitFrameFinished();
+	m_shaderDatabase.swapOptimizedPipelines(m_frameCounter);
 
 	// update instance list & frame resource state
 	auto instances = m_activeScene.generateRenderInstanceList(m_camera);
 	m_frameResources.frameIndex = m_frameCounter;
-	m_frameResources.accumulate = useTemporalAccumulation;
+	m_frameResources.accumulate = useTemporalAccumulation && !(usePathTracer && useProgressiveAccumulation);	// Progressive accumulation already converges, TAA clamping would only bias it
 	m_frameResources.activeScene = &m_activeScene;
+	m_temporalReprojectPass->tileSize = computeTileSize;
+	m_pathTracingPass->maxBounceCount = pathTracerBounceCount;
+	m_pathTracingPass->rouletteBounceCount = pathTracerRouletteBounceCount;
+	m_pathTracingPass->samplesPerPixel = pathTracerSamplesPerPixel;
+	m_pathTracingPass->progressiveAccumulation = useProgressiveAccumulation;
 
 	// Copy SSBO & UBO data to buffers and check if TLAS realloc is needed
 	hri::CameraShaderData prevCam = m_prevCamera.getShaderData();
-	hri::CameraShaderData currCam = m_camera.getShaderData();
+	hri::CameraShaderData currCam = m_camera.getShaderData(m_prevCamera);
 
 	m_frameResources.prevCameraUBO->copyToBuffer(&prevCam, sizeof(hri::CameraShaderData));
 	m_frameResources.cameraUBO->copyToBuffer(&currCam, sizeof(hri::CameraShaderData));
+
+	// Scene lights are uploaded once & shared by all passes that evaluate them, the buffer only grows
+	const auto& lights = m_activeScene.getLightList();
+	m_frameResources.lightCount = static_cast<uint32_t>(lights.size());
+
+	size_t lightSize = hri::max<size_t>(lights.size(), 1) * sizeof(LightArrayEntry);
+	if (m_frameResources.lightSSBO == nullptr || m_frameResources.lightSSBO->bufferSize < lightSize)
+		m_frameResources.lightSSBO = std::unique_ptr<hri::BufferResource>(new hri::BufferResource(m_context, lightSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, true));
+
+	if (!lights.empty())
+		m_frameResources.lightSSBO->copyToBuffer(lights.data(), lights.size() * sizeof(LightArrayEntry));
+
+	// Accumulated path tracer samples are invalid once the camera or any instance moved
+	bool sceneChanged = prevCam.viewProject != currCam.viewProject;
+	for (const auto& instance : instances)
+		sceneChanged |= instance.modelMatrix != instance.prevModelMatrix;
+
+	if (sceneChanged)
+		m_pathTracingPass->resetAccumulation();
 	if (m_accelerationStructureManager.shouldReallocTLAS(*m_frameResources.tlas, instances, m_frameResources.blasList))
 		m_frameResources.tlas = std::make_unique<raytracing::AccelerationStructure>(m_accelerationStructureManager.createTLAS(instances, m_frameResources.blasList));
 
@@ -83,45 +126,29 @@ void Renderer::prepareFrame()
 	m_computePool.submitAndWait(ASBuildCommands);
 	m_computePool.freeCommandBuffer(ASBuildCommands);
 
-	// Prepare pass I/O descriptors
+	// Prepare pass I/O descriptors, bindless inputs only need their indices selected
 	if (usePathTracer)
 	{
-		VkDescriptorImageInfo temporalResultInfo = VkDescriptorImageInfo{};
-		temporalResultInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		temporalResultInfo.imageView = m_pathTracingPass->renderResult->view;
-		temporalResultInfo.sampler = m_temporalReprojectPass->passInputSampler->sampler;
-
-		VkDescriptorImageInfo temporalNormalInfo = VkDescriptorImageInfo{};
-		temporalNormalInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		temporalNormalInfo.imageView = m_pathTracingPass->renderNormalResult->view;
-		temporalNormalInfo.sampler = m_temporalReprojectPass->passInputSampler->sampler;
-
-		VkDescriptorImageInfo temporalDepthInfo = VkDescriptorImageInfo{};
-		temporalDepthInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		temporalDepthInfo.imageView = m_pathTracingPass->renderDepthResult->view;
-		temporalDepthInfo.sampler = m_temporalReprojectPass->passInputSampler->sampler;
-		
-		(*m_temporalReprojectPass->inputDescriptorSet)
-			.writeImage(6, &temporalResultInfo)
-			.writeImage(7, &temporalNormalInfo)
-			.writeImage(8, &temporalDepthInfo)
-			.flush();
+		m_temporalReprojectPass->inputIndices = m_pathTracerTemporalInputs;
 	}
 	else
 	{
+		m_temporalReprojectPass->inputIndices = m_hybridTemporalInputs;
+
 		// Set GBuffer sampling descriptors
 		auto writeGBufferSampleDescriptors = [](
 			hri::DescriptorSetManager& descriptorSet,
 			hri::ImageSampler& sampler,
-			hri::RenderPassResourceManager& manager
+			GBufferLayoutPass& layoutPass,
+			GBufferLayoutPass::LODMode mode
 		) {
-			VkDescriptorImageInfo albedoInfo = VkDescriptorImageInfo{ sampler.sampler, manager.getAttachmentResource(0).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-			VkDescriptorImageInfo emissionInfo = VkDescriptorImageInfo{ sampler.sampler, manager.getAttachmentResource(1).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-			VkDescriptorImageInfo specularInfo = VkDescriptorImageInfo{ sampler.sampler, manager.getAttachmentResource(2).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-			VkDescriptorImageInfo transmittanceInfo = VkDescriptorImageInfo{ sampler.sampler, manager.getAttachmentResource(3).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-			VkDescriptorImageInfo normalInfo = VkDescriptorImageInfo{ sampler.sampler, manager.getAttachmentResource(4).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-			VkDescriptorImageInfo maskInfo = VkDescriptorImageInfo{ sampler.sampler, manager.getAttachmentResource(5).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-			VkDescriptorImageInfo depthInfo = VkDescriptorImageInfo{ sampler.sampler, manager.getAttachmentResource(6).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			VkDescriptorImageInfo albedoInfo = VkDescriptorImageInfo{ sampler.sampler, layoutPass.getLODAttachmentView(mode, 0), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			VkDescriptorImageInfo emissionInfo = VkDescriptorImageInfo{ sampler.sampler, layoutPass.getLODAttachmentView(mode, 1), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			VkDescriptorImageInfo specularInfo = VkDescriptorImageInfo{ sampler.sampler, layoutPass.getLODAttachmentView(mode, 2), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			VkDescriptorImageInfo transmittanceInfo = VkDescriptorImageInfo{ sampler.sampler, layoutPass.getLODAttachmentView(mode, 3), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			VkDescriptorImageInfo normalInfo = VkDescriptorImageInfo{ sampler.sampler, layoutPass.getLODAttachmentView(mode, 4), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			VkDescriptorImageInfo maskInfo = VkDescriptorImageInfo{ sampler.sampler, layoutPass.getLODAttachmentView(mode, 5), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			VkDescriptorImageInfo depthInfo = VkDescriptorImageInfo{ sampler.sampler, layoutPass.getLODAttachmentView(mode, 6), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
 
 			descriptorSet
 				.writeImage(0, &albedoInfo)
@@ -134,118 +161,160 @@ void Renderer::prepareFrame()
 				.flush();
 		};
 
-		VkDescriptorImageInfo rngSourceInfo = VkDescriptorImageInfo{};
-		rngSourceInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		rngSourceInfo.imageView = m_rngGenPass->rngSource->view;
-		rngSourceInfo.sampler = m_gbufferSamplePass->passInputSampler->sampler;
-		(*m_gbufferSamplePass->rngDescriptorSet)
-			.writeImage(0, &rngSourceInfo)
-			.flush();
-
-		writeGBufferSampleDescriptors(*m_gbufferSamplePass->loDefDescriptorSet, *m_gbufferSamplePass->passInputSampler, *m_gbufferLayoutPass->loDefLODPassResources);
-		writeGBufferSampleDescriptors(*m_gbufferSamplePass->hiDefDescriptorSet, *m_gbufferSamplePass->passInputSampler, *m_gbufferLayoutPass->hiDefLODPassResources);
-
-		// Set direct illumination descriptors
-		VkDescriptorImageInfo DIAlbedoInfo = VkDescriptorImageInfo{ m_directIlluminationPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(0).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		VkDescriptorImageInfo DIEmissionInfo = VkDescriptorImageInfo{ m_directIlluminationPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(1).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		VkDescriptorImageInfo DISpecularInfo = VkDescriptorImageInfo{ m_directIlluminationPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(2).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		VkDescriptorImageInfo DITransmittanceInfo = VkDescriptorImageInfo{ m_directIlluminationPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(3).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		VkDescriptorImageInfo DINormalInfo = VkDescriptorImageInfo{ m_directIlluminationPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(4).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		VkDescriptorImageInfo DIDepthInfo = VkDescriptorImageInfo{ m_directIlluminationPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(5).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		rngSourceInfo.sampler = m_directIlluminationPass->passInputSampler->sampler;
-		(*m_directIlluminationPass->gbufferDataDescriptorSet)
-			.writeImage(0, &DIAlbedoInfo)
-			.writeImage(1, &DIEmissionInfo)
-			.writeImage(2, &DISpecularInfo)
-			.writeImage(3, &DITransmittanceInfo)
-			.writeImage(4, &DINormalInfo)
-			.writeImage(5, &DIDepthInfo)
-			.writeImage(6, &rngSourceInfo)
-			.flush();
-
-		// Set Deferred shading descriptors
-		VkDescriptorImageInfo deferredAlbedoInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(0).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		VkDescriptorImageInfo deferredEmissionInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(1).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		VkDescriptorImageInfo deferredSpecularInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(2).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		VkDescriptorImageInfo deferredTransmittanceInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(3).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		VkDescriptorImageInfo deferredNormalInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(4).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		VkDescriptorImageInfo deferredDepthInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(5).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		VkDescriptorImageInfo deferredDIInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_directIlluminationPass->renderResult->view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-		(*m_deferredShadingPass->inputDescriptorSet)
-			.writeImage(0, &deferredAlbedoInfo)
-			.writeImage(1, &deferredEmissionInfo)
-			.writeImage(2, &deferredSpecularInfo)
-			.writeImage(3, &deferredTransmittanceInfo)
-			.writeImage(4, &deferredNormalInfo)
-			.writeImage(5, &deferredDepthInfo)
-			.writeImage(6, &deferredDIInfo)
-			.flush();
-
-		VkDescriptorImageInfo temporalResultInfo = VkDescriptorImageInfo{};
-		temporalResultInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		temporalResultInfo.imageView = m_deferredShadingPass->passResources->getAttachmentResource(0).view;
-		temporalResultInfo.sampler = m_temporalReprojectPass->passInputSampler->sampler;
-
-		VkDescriptorImageInfo temporalNormalInfo = VkDescriptorImageInfo{};
-		temporalNormalInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		temporalNormalInfo.imageView = m_gbufferSamplePass->passResources->getAttachmentResource(4).view;
-		temporalNormalInfo.sampler = m_temporalReprojectPass->passInputSampler->sampler;
-
-		VkDescriptorImageInfo temporalDepthInfo = VkDescriptorImageInfo{};
-		temporalDepthInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		temporalDepthInfo.imageView = m_gbufferSamplePass->passResources->getAttachmentResource(5).view;
-		temporalDepthInfo.sampler = m_temporalReprojectPass->passInputSampler->sampler;
-
-		(*m_temporalReprojectPass->inputDescriptorSet)
-			.writeImage(6, &temporalResultInfo)
-			.writeImage(7, &temporalNormalInfo)
-			.writeImage(8, &temporalDepthInfo)
-			.flush();
+		if (m_fusedGBufferShading)
+		{
+			// Direct illumination & shading both select the GBuffer LOD themselves
+			writeGBufferSampleDescriptors(*m_directIlluminationPass->loDefDescriptorSet, *m_directIlluminationPass->passInputSampler, *m_gbufferLayoutPass, GBufferLayoutPass::LODMode::LODFar);
+			writeGBufferSampleDescriptors(*m_directIlluminationPass->hiDefDescriptorSet, *m_directIlluminationPass->passInputSampler, *m_gbufferLayoutPass, GBufferLayoutPass::LODMode::LODNear);
+			writeGBufferSampleDescriptors(*m_gbufferShadingPass->loDefDescriptorSet, *m_gbufferShadingPass->passInputSampler, *m_gbufferLayoutPass, GBufferLayoutPass::LODMode::LODFar);
+			writeGBufferSampleDescriptors(*m_gbufferShadingPass->hiDefDescriptorSet, *m_gbufferShadingPass->passInputSampler, *m_gbufferLayoutPass, GBufferLayoutPass::LODMode::LODNear);
+
+			VkDescriptorImageInfo shadingDIInfo = VkDescriptorImageInfo{ m_gbufferShadingPass->passInputSampler->sampler, m_directIlluminationPass->renderResult->view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+			(*m_gbufferShadingPass->shadingDescriptorSet)
+				.writeImage(0, &shadingDIInfo)
+				.flush();
+		}
+		else
+		{
+			writeGBufferSampleDescriptors(*m_gbufferSamplePass->loDefDescriptorSet, *m_gbufferSamplePass->passInputSampler, *m_gbufferLayoutPass, GBufferLayoutPass::LODMode::LODFar);
+			writeGBufferSampleDescriptors(*m_gbufferSamplePass->hiDefDescriptorSet, *m_gbufferSamplePass->passInputSampler, *m_gbufferLayoutPass, GBufferLayoutPass::LODMode::LODNear);
+
+			if (m_subpassDeferredShading)
+			{
+				// Direct illumination runs before the sample pass, so it selects the GBuffer LOD itself
+				writeGBufferSampleDescriptors(*m_directIlluminationPass->loDefDescriptorSet, *m_directIlluminationPass->passInputSampler, *m_gbufferLayoutPass, GBufferLayoutPass::LODMode::LODFar);
+				writeGBufferSampleDescriptors(*m_directIlluminationPass->hiDefDescriptorSet, *m_directIlluminationPass->passInputSampler, *m_gbufferLayoutPass, GBufferLayoutPass::LODMode::LODNear);
+
+				VkDescriptorImageInfo shadingDIInfo = VkDescriptorImageInfo{ m_gbufferSamplePass->passInputSampler->sampler, m_directIlluminationPass->renderResult->view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				(*m_gbufferSamplePass->shadingDescriptorSet)
+					.writeImage(3, &shadingDIInfo)
+					.flush();
+			}
+			else
+			{
+				// Set direct illumination descriptors
+				VkDescriptorImageInfo DIAlbedoInfo = VkDescriptorImageInfo{ m_directIlluminationPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(0).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				VkDescriptorImageInfo DIEmissionInfo = VkDescriptorImageInfo{ m_directIlluminationPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(1).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				VkDescriptorImageInfo DISpecularInfo = VkDescriptorImageInfo{ m_directIlluminationPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(2).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				VkDescriptorImageInfo DITransmittanceInfo = VkDescriptorImageInfo{ m_directIlluminationPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(3).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				VkDescriptorImageInfo DINormalInfo = VkDescriptorImageInfo{ m_directIlluminationPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(4).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				VkDescriptorImageInfo DIDepthInfo = VkDescriptorImageInfo{ m_directIlluminationPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(5).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				(*m_directIlluminationPass->gbufferDataDescriptorSet)
+					.writeImage(0, &DIAlbedoInfo)
+					.writeImage(1, &DIEmissionInfo)
+					.writeImage(2, &DISpecularInfo)
+					.writeImage(3, &DITransmittanceInfo)
+					.writeImage(4, &DINormalInfo)
+					.writeImage(5, &DIDepthInfo)
+					.flush();
+
+				// Set Deferred shading descriptors
+				VkDescriptorImageInfo deferredAlbedoInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(0).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				VkDescriptorImageInfo deferredEmissionInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(1).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				VkDescriptorImageInfo deferredSpecularInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(2).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				VkDescriptorImageInfo deferredTransmittanceInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(3).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				VkDescriptorImageInfo deferredNormalInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(4).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				VkDescriptorImageInfo deferredDepthInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_gbufferSamplePass->passResources->getAttachmentResource(5).view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				VkDescriptorImageInfo deferredDIInfo = VkDescriptorImageInfo{ m_deferredShadingPass->passInputSampler->sampler, m_directIlluminationPass->renderResult->view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+				(*m_deferredShadingPass->inputDescriptorSet)
+					.writeImage(0, &deferredAlbedoInfo)
+					.writeImage(1, &deferredEmissionInfo)
+					.writeImage(2, &deferredSpecularInfo)
+					.writeImage(3, &deferredTransmittanceInfo)
+					.writeImage(4, &deferredNormalInfo)
+					.writeImage(5, &deferredDepthInfo)
+					.writeImage(6, &deferredDIInfo)
+					.flush();
+			}
+		}
 	}
 
+	if (!m_temporalPresentBlit)
+		m_presentPass->renderResultIndex = m_temporalReprojectPass->getRenderResultIndex();
 
-	VkDescriptorImageInfo renderResultInfo = VkDescriptorImageInfo{};
-	renderResultInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	renderResultInfo.imageView = m_temporalReprojectPass->getRenderResultView();
-	renderResultInfo.sampler = m_presentPass->passInputSampler->sampler;
-
-	(*m_presentPass->presentDescriptorSet)
-		.writeImage(0, &renderResultInfo)
-		.flush();
+	if (m_tiledLightCulling)
+	{
+		if (m_fusedGBufferShading)
+			m_gbufferShadingPass->lightListSet = m_lightCullingPass->lightListDescriptorSet->set;
+		else
+			m_deferredShadingPass->lightListSet = m_lightCullingPass->lightListDescriptorSet->set;
+	}
 
 	// Prepare per pass frame resources
-	m_rngGenPass->prepareFrame(m_frameResources);
 	m_pathTracingPass->prepareFrame(m_frameResources);
 	m_gbufferLayoutPass->prepareFrame(m_frameResources);
-	m_gbufferSamplePass->prepareFrame(m_frameResources);
 	m_directIlluminationPass->prepareFrame(m_frameResources);
-	m_deferredShadingPass->prepareFrame(m_frameResources);
+
+	if (m_tiledLightCulling)
+		m_lightCullingPass->prepareFrame(m_frameResources);
+
+	if (m_fusedGBufferShading)
+	{
+		m_gbufferShadingPass->prepareFrame(m_frameResources);
+	}
+	else if (m_subpassDeferredShading)
+	{
+		m_gbufferSamplePass->prepareFrame(m_frameResources);
+	}
+	else
+	{
+		m_gbufferSamplePass->prepareFrame(m_frameResources);
+		m_deferredShadingPass->prepareFrame(m_frameResources);
+	}
+
 	m_temporalReprojectPass->prepareFrame(m_frameResources);
-	m_presentPass->prepareFrame(m_frameResources);
+
+	if (!m_temporalPresentBlit)
+		m_presentPass->prepareFrame(m_frameResources);
+
 	m_uiPass->prepareFrame(m_frameResources);
 }
 
 void Renderer::drawFrame()
 {
 #if SHOW_DEBUG_OUTPUT == 1
+	// Tiled light culling replaces the DI pass in the fused & deferred configurations
+	const char* lightPassName = m_tiledLightCulling ? "LightCull" : "DI";
+	float lightPassTime = m_tiledLightCulling ? m_lightCullingPass->debug.timeDelta() : m_directIlluminationPass->debug.timeDelta();
+
 	if (usePathTracer)
 	{
 		printf(
-			"RNGGen: %8.4f ms, PathTracing: %8.4f ms, Reproject: %8.4f ms, AS Build %8.4f ms\n",
-			m_rngGenPass->debug.timeDelta(),
+			"PathTracing: %8.4f ms, Reproject: %8.4f ms, AS Build %8.4f ms\n",
 			m_pathTracingPass->debug.timeDelta(),
 			m_temporalReprojectPass->debug.timeDelta(),
 			m_asBuildTimer.timeDelta()
 		);
 	}
+	else if (m_fusedGBufferShading)
+	{
+		printf(
+			"GBufLayout: %8.4f ms, %s: %8.4f ms, GBufShading: %8.4f ms, Reproject: %8.4f ms, AS Build %8.4f ms\n",
+			m_gbufferLayoutPass->debug.timeDelta(),
+			lightPassName, lightPassTime,
+			m_gbufferShadingPass->debug.timeDelta(),
+			m_temporalReprojectPass->debug.timeDelta(),
+			m_asBuildTimer.timeDelta()
+		);
+	}
+	else if (m_subpassDeferredShading)
+	{
+		printf(
+			"GBufLayout: %8.4f ms, DI: %8.4f ms, GBufSample + DS: %8.4f ms, Reproject: %8.4f ms, AS Build %8.4f ms\n",
+			m_gbufferLayoutPass->debug.timeDelta(),
+			m_directIlluminationPass->debug.timeDelta(),
+			m_gbufferSamplePass->debug.timeDelta(),
+			m_temporalReprojectPass->debug.timeDelta(),
+			m_asBuildTimer.timeDelta()
+		);
+	}
 	else
 	{
 		printf(
-			"RNGGen: %8.4f ms, GBufLayout: %8.4f ms, GBufSample: %8.4f ms, DI: %8.4f ms, DS: %8.4f ms, Reproject: %8.4f ms, AS Build %8.4f ms\n",
-			m_rngGenPass->debug.timeDelta(),
+			"GBufLayout: %8.4f ms, GBufSample: %8.4f ms, %s: %8.4f ms, DS: %8.4f ms, Reproject: %8.4f ms, AS Build %8.4f ms\n",
 			m_gbufferLayoutPass->debug.timeDelta(),
 			m_gbufferSamplePass->debug.timeDelta(),
-			m_directIlluminationPass->debug.timeDelta(),
+			lightPassName, lightPassTime,
 			m_deferredShadingPass->debug.timeDelta(),
 			m_temporalReprojectPass->debug.timeDelta(),
 			m_asBuildTimer.timeDelta()
@@ -259,22 +328,46 @@ void Renderer::drawFrame()
 	// Begin command recording for this frame
 	frame.beginCommands();
 
-	m_rngGenPass->drawFrame(frame, m_frameResources);
-
 	if (usePathTracer)
 	{
 		m_pathTracingPass->drawFrame(frame, m_frameResources);
 	}
+	else if (m_fusedGBufferShading)
+	{
+		m_gbufferLayoutPass->drawFrame(frame, m_frameResources);
+
+		// Tiled analytic lights replace the traced direct illumination
+		if (m_tiledLightCulling)
+			m_lightCullingPass->drawFrame(frame, m_frameResources);
+		else
+			m_directIlluminationPass->drawFrame(frame, m_frameResources);
+
+		m_gbufferShadingPass->drawFrame(frame, m_frameResources);
+	}
+	else if (m_subpassDeferredShading)
+	{
+		m_gbufferLayoutPass->drawFrame(frame, m_frameResources);
+		m_directIlluminationPass->drawFrame(frame, m_frameResources);
+		m_gbufferSamplePass->drawFrame(frame, m_frameResources);
+	}
 	else
 	{
 		m_gbufferLayoutPass->drawFrame(frame, m_frameResources);
 		m_gbufferSamplePass->drawFrame(frame, m_frameResources);
-		m_directIlluminationPass->drawFrame(frame, m_frameResources);
+
+		if (m_tiledLightCulling)
+			m_lightCullingPass->drawFrame(frame, m_frameResources);
+		else
+			m_directIlluminationPass->drawFrame(frame, m_frameResources);
+
 		m_deferredShadingPass->drawFrame(frame, m_frameResources);
 	}
 
 	m_temporalReprojectPass->drawFrame(frame, m_frameResources);
-	m_presentPass->drawFrame(frame, m_frameResources);
+
+	if (!m_temporalPresentBlit)
+		m_presentPass->drawFrame(frame, m_frameResources);
+
 	m_uiPass->drawFrame(frame, m_frameResources);
 
 	frame.endCommands();
@@ -284,31 +377,126 @@ void Renderer::drawFrame()
 	m_prevCamera = m_camera;
 }
 
+void Renderer::resetAccumulation()
+{
+	m_pathTracingPass->resetAccumulation();
+}
+
+Renderer::ComputePassTimings Renderer::getComputePassTimings() const
+{
+	return ComputePassTimings{
+		m_temporalReprojectPass->debug.timeDelta(),
+	};
+}
+
 void Renderer::initRenderPasses()
 {
-	m_rngGenPass = std::unique_ptr<RngGenerationPass>(new RngGenerationPass(m_context, m_shaderDatabase, m_descriptorSetAllocator));
 	m_pathTracingPass = std::unique_ptr<PathTracingPass>(new PathTracingPass(m_raytracingContext, m_shaderDatabase, m_descriptorSetAllocator));
 	m_gbufferLayoutPass = std::unique_ptr<GBufferLayoutPass>(new GBufferLayoutPass(m_context, m_shaderDatabase, m_descriptorSetAllocator));
-	m_gbufferSamplePass = std::unique_ptr<GBufferSamplePass>(new GBufferSamplePass(m_context, m_shaderDatabase, m_descriptorSetAllocator));
-	m_directIlluminationPass = std::unique_ptr<DirectIlluminationPass>(new DirectIlluminationPass(m_raytracingContext, m_shaderDatabase, m_descriptorSetAllocator));
-	m_deferredShadingPass = std::unique_ptr<DeferredShadingPass>(new DeferredShadingPass(m_context, m_shaderDatabase, m_descriptorSetAllocator));
-	m_temporalReprojectPass = std::unique_ptr<TemporalReprojectPass>(new TemporalReprojectPass(m_context, m_shaderDatabase, m_descriptorSetAllocator));
-	m_presentPass = std::unique_ptr<PresentPass>(new PresentPass(m_context, m_shaderDatabase, m_descriptorSetAllocator));
+	m_directIlluminationPass = std::unique_ptr<DirectIlluminationPass>(new DirectIlluminationPass(m_raytracingContext, m_shaderDatabase, m_descriptorSetAllocator, m_fusedGBufferShading || m_subpassDeferredShading));
+
+	const hri::DescriptorSetLayout* lightListSetLayout = nullptr;
+	if (m_tiledLightCulling)
+	{
+		m_lightCullingPass = std::unique_ptr<LightCullingPass>(new LightCullingPass(m_context, m_shaderDatabase, m_descriptorSetAllocator));
+		lightListSetLayout = m_lightCullingPass->lightListDescriptorSetLayout.get();
+	}
+
+	if (m_fusedGBufferShading)
+	{
+		m_gbufferShadingPass = std::unique_ptr<GBufferShadingPass>(new GBufferShadingPass(m_context, m_shaderDatabase, m_descriptorSetAllocator, lightListSetLayout));
+	}
+	else if (m_subpassDeferredShading)
+	{
+		m_gbufferSamplePass = std::unique_ptr<GBufferSamplePass>(new GBufferSamplePass(m_context, m_shaderDatabase, m_descriptorSetAllocator, DEMO_PACKED_GBUFFER, true));
+	}
+	else
+	{
+		m_gbufferSamplePass = std::unique_ptr<GBufferSamplePass>(new GBufferSamplePass(m_context, m_shaderDatabase, m_descriptorSetAllocator, DEMO_PACKED_GBUFFER, false));
+		m_deferredShadingPass = std::unique_ptr<DeferredShadingPass>(new DeferredShadingPass(m_context, m_shaderDatabase, m_descriptorSetAllocator, lightListSetLayout));
+	}
+
+	m_temporalReprojectPass = std::unique_ptr<TemporalReprojectPass>(new TemporalReprojectPass(m_context, m_shaderDatabase, m_descriptorSetAllocator, m_bindlessDescriptorSet, m_temporalPresentBlit));
+
+	if (!m_temporalPresentBlit)
+		m_presentPass = std::unique_ptr<PresentPass>(new PresentPass(m_context, m_shaderDatabase, m_bindlessDescriptorSet));
+
 	m_uiPass = std::unique_ptr<UIPass>(new UIPass(m_context, m_descriptorSetAllocator.fixedPool()));
+
+	storeBindlessPassInputs();
+
+	// Passes start out with fast linked pipelines, optimized versions are swapped in once ready
+	m_shaderDatabase.optimizeLinkedPipelines();
+}
+
+void Renderer::storeBindlessPassInputs()
+{
+	VkSampler inputSampler = m_temporalReprojectPass->passInputSampler->sampler;
+	auto storeSampledImage = [&](uint32_t& index, VkImageView view) {
+		VkDescriptorImageInfo imageInfo = VkDescriptorImageInfo{ inputSampler, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+		if (index == HRI_BINDLESS_INVALID_INDEX)
+			index = m_bindlessDescriptorSet.storeImage(hri::BindlessResourceType::SampledImage, imageInfo);
+		else
+			m_bindlessDescriptorSet.updateImage(hri::BindlessResourceType::SampledImage, index, imageInfo);
+	};
+
+	// Path tracer outputs
+	storeSampledImage(m_pathTracerTemporalInputs.renderResult, m_pathTracingPass->renderResult->view);
+	storeSampledImage(m_pathTracerTemporalInputs.renderNormal, m_pathTracingPass->renderNormalResult->view);
+	storeSampledImage(m_pathTracerTemporalInputs.renderDepth, m_pathTracingPass->renderDepthResult->view);
+
+	// Hybrid renderer outputs
+	if (m_fusedGBufferShading)
+	{
+		storeSampledImage(m_hybridTemporalInputs.renderResult, m_gbufferShadingPass->renderResult->view);
+		storeSampledImage(m_hybridTemporalInputs.renderNormal, m_gbufferShadingPass->renderNormal->view);
+		storeSampledImage(m_hybridTemporalInputs.renderDepth, m_gbufferShadingPass->renderDepth->view);
+		storeSampledImage(m_hybridTemporalInputs.renderVelocity, m_gbufferShadingPass->renderVelocity->view);
+	}
+	else if (m_subpassDeferredShading)
+	{
+		storeSampledImage(m_hybridTemporalInputs.renderResult, m_gbufferSamplePass->passResources->getAttachmentResource(GBufferSamplePass::ShadingResultAttachment).view);
+		storeSampledImage(m_hybridTemporalInputs.renderNormal, m_gbufferSamplePass->passResources->getAttachmentResource(4).view);
+		storeSampledImage(m_hybridTemporalInputs.renderDepth, m_gbufferSamplePass->passResources->getAttachmentResource(5).view);
+		storeSampledImage(m_hybridTemporalInputs.renderVelocity, m_gbufferSamplePass->passResources->getAttachmentResource(GBufferSamplePass::VelocityAttachment).view);
+	}
+	else
+	{
+		storeSampledImage(m_hybridTemporalInputs.renderResult, m_deferredShadingPass->passResources->getAttachmentResource(0).view);
+		storeSampledImage(m_hybridTemporalInputs.renderNormal, m_gbufferSamplePass->passResources->getAttachmentResource(4).view);
+		storeSampledImage(m_hybridTemporalInputs.renderDepth, m_gbufferSamplePass->passResources->getAttachmentResource(5).view);
+		storeSampledImage(m_hybridTemporalInputs.renderVelocity, m_gbufferSamplePass->passResources->getAttachmentResource(GBufferSamplePass::VelocityAttachment).view);
+	}
 }
 
 void Renderer::recreateSwapDependentResources(const vkb::Swapchain& swapchain)
 {
-	m_rngGenPass->recreateResources(swapchain.extent);
 	m_pathTracingPass->recreateResources(swapchain.extent);
-	m_gbufferLayoutPass->loDefLODPassResources->recreateResources();
-	m_gbufferLayoutPass->hiDefLODPassResources->recreateResources();
-	m_gbufferSamplePass->passResources->recreateResources();
+	m_gbufferLayoutPass->recreateResources();
 	m_directIlluminationPass->recreateResources(swapchain.extent);
-	m_deferredShadingPass->passResources->recreateResources();
+
+	if (m_tiledLightCulling)
+		m_lightCullingPass->recreateResources(swapchain.extent);
+
+	if (m_fusedGBufferShading)
+	{
+		m_gbufferShadingPass->recreateResources(swapchain.extent);
+	}
+	else
+	{
+		m_gbufferSamplePass->passResources->recreateResources();
+
+		if (!m_subpassDeferredShading)
+			m_deferredShadingPass->passResources->recreateResources();
+	}
+
 	m_temporalReprojectPass->recreateResources(swapchain.extent);
-	m_presentPass->passResources->recreateResources();
+
+	if (!m_temporalPresentBlit)
+		m_presentPass->passResources->recreateResources();
+
 	m_uiPass->passResources->recreateResources();
+	storeBindlessPassInputs();
 
 	// XXX: hacky way to ensure resources are valid, check if this should be done differently
 	prepareFrame();
@@ -280,6 +280,30 @@ std::vector<raytracing::ASBuilder::ASInput> SceneASManager::generateBLASInputs(c
 	return blasInputs;
 }
 
+/// @brief Get the total vertex count of a list of meshes.
+/// @param meshes Meshes to count.
+/// @return The summed vertex count.
+static size_t getTotalVertexCount(const std::vector<hri::Mesh>& meshes)
+{
+	size_t vertexCount = 0;
+	for (auto const& mesh : meshes)
+		vertexCount += mesh.vertexCount;
+
+	return vertexCount;
+}
+
+/// @brief Get the total index count of a list of meshes.
+/// @param meshes Meshes to count.
+/// @return The summed index count.
+static size_t getTotalIndexCount(const std::vector<hri::Mesh>& meshes)
+{
+	size_t indexCount = 0;
+	for (auto const& mesh : meshes)
+		indexCount += mesh.indexCount;
+
+	return indexCount;
+}
+
 SceneGraph::SceneGraph(
 	raytracing::RayTracingContext& ctx,
 	std::vector<Material>&& materials,
@@ -295,7 +319,7 @@ SceneGraph::SceneGraph(
 	buffers{
 		hri::BufferResource(
 			ctx.renderContext,
-			sizeof(RenderInstance) * this->meshes.size(),
+			sizeof(RenderInstanceData) * this->meshes.size(),
 			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
 			| VK_BUFFER_USAGE_TRANSFER_DST_BIT
 		),
@@ -305,6 +329,24 @@ SceneGraph::SceneGraph(
 			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
 			| VK_BUFFER_USAGE_TRANSFER_DST_BIT
 		),
+		hri::BufferResource(
+			ctx.renderContext,
+			sizeof(hri::Vertex) * getTotalVertexCount(this->meshes),
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+			| VK_BUFFER_USAGE_TRANSFER_DST_BIT
+		),
+		hri::BufferResource(
+			ctx.renderContext,
+			sizeof(hri::Float3) * getTotalVertexCount(this->meshes),
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT
+			| VK_BUFFER_USAGE_TRANSFER_DST_BIT
+		),
+		hri::BufferResource(
+			ctx.renderContext,
+			sizeof(uint32_t) * getTotalIndexCount(this->meshes),
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT
+			| VK_BUFFER_USAGE_TRANSFER_DST_BIT
+		),
 	}
 {
 	hri::CommandPool stagingPool = hri::CommandPool(
@@ -313,8 +355,24 @@ SceneGraph::SceneGraph(
 		VK_COMMAND_POOL_CREATE_TRANSIENT_BIT
 	);
 
-	// Set up render instance data for all meshes
+	// Set up render instance data for all meshes, meshes are laid out sequentially in the scene geometry buffers
 	m_instanceData.resize(this->meshes.size());
+
+	uint32_t firstIndex = 0;
+	int32_t vertexOffset = 0;
+	for (size_t meshIdx = 0; meshIdx < this->meshes.size(); meshIdx++)
+	{
+		const hri::Mesh& mesh = this->meshes[meshIdx];
+		RenderInstanceData& instanceData = m_instanceData[meshIdx];
+
+		instanceData.firstIndex = firstIndex;
+		instanceData.vertexOffset = vertexOffset;
+		instanceData.boundingSphere = hri::Float4(mesh.boundsCenter.x, mesh.boundsCenter.y, mesh.boundsCenter.z, mesh.boundsRadius);
+
+		firstIndex += mesh.indexCount;
+		vertexOffset += static_cast<int32_t>(mesh.vertexCount);
+	}
+
 	for (auto const& node : this->nodes)
 	{
 		const Material& mat = this->materials[node.material];
@@ -353,6 +411,20 @@ SceneGraph::SceneGraph(
 	vkCmdCopyBuffer(transferBuffer, instanceStaging.buffer, buffers.instanceDataSSBO.buffer, 1, &instanceSSBOCopy);
 	vkCmdCopyBuffer(transferBuffer, materialStaging.buffer, buffers.materialSSBO.buffer, 1, &matSSBOCopy);
 
+	for (size_t meshIdx = 0; meshIdx < this->meshes.size(); meshIdx++)
+	{
+		const hri::Mesh& mesh = this->meshes[meshIdx];
+		const RenderInstanceData& instanceData = m_instanceData[meshIdx];
+
+		VkBufferCopy vertexCopy = VkBufferCopy{ 0, sizeof(hri::Vertex) * instanceData.vertexOffset, mesh.vertexBuffer.bufferSize };
+		VkBufferCopy positionCopy = VkBufferCopy{ 0, sizeof(hri::Float3) * instanceData.vertexOffset, mesh.positionBuffer.bufferSize };
+		VkBufferCopy indexCopy = VkBufferCopy{ 0, sizeof(uint32_t) * instanceData.firstIndex, mesh.indexBuffer.bufferSize };
+
+		vkCmdCopyBuffer(transferBuffer, mesh.vertexBuffer.buffer, buffers.vertexBuffer.buffer, 1, &vertexCopy);
+		vkCmdCopyBuffer(transferBuffer, mesh.positionBuffer.buffer, buffers.positionBuffer.buffer, 1, &positionCopy);
+		vkCmdCopyBuffer(transferBuffer, mesh.indexBuffer.buffer, buffers.indexBuffer.buffer, 1, &indexCopy);
+	}
+
 	stagingPool.submitAndWait(transferBuffer);
 
 	printf("Loaded scene with %zu instances (%u light(s))\n", m_instanceData.size(), lightCount);
@@ -370,24 +442,78 @@ const std::vector<RenderInstance>& SceneGraph::getRenderInstanceList() const
 
 const std::vector<RenderInstance>& SceneGraph::generateRenderInstanceList(const hri::Camera& camera)
 {
+	// Instances are generated in node order, so last frame's list holds each node's previous transform
+	std::vector<RenderInstance> prevInstances = std::move(m_instances);
 	m_instances.clear();
+	m_lights.clear();
 
-	for (auto const& node : nodes)
+	for (size_t nodeIdx = 0; nodeIdx < nodes.size(); nodeIdx++)
 	{
+		const SceneNode& node = nodes[nodeIdx];
 		float blendFactor = 0.0;
 		SceneNode::SceneId meshLOD0, meshLOD1;
 		calculateLODLevel(camera, node, blendFactor, meshLOD0, meshLOD1);
 		assert(meshLOD0 != INVALID_SCENE_ID && meshLOD1 != INVALID_SCENE_ID);
 
+		hri::Float4x4 modelMatrix = node.transform.modelMatrix();
+		hri::Float4x4 prevModelMatrix = nodeIdx < prevInstances.size() ? prevInstances[nodeIdx].modelMatrix : modelMatrix;
+
 		// TODO: upload mesh data into scene buffers, build TLAS from instance BLASses
 		m_instances.push_back(RenderInstance{
-			node.transform.modelMatrix(),
+			modelMatrix,
+			prevModelMatrix,
 			blendFactor,
 			static_cast<uint32_t>(meshLOD0),
 			static_cast<uint32_t>(meshLOD1),
 		});
+
+		const Material& material = materials[node.material];
+		float maxEmission = hri::max(material.emission.x, hri::max(material.emission.y, material.emission.z));
+		if (maxEmission <= 0.0f)
+			continue;
+
+		// Emissive instances are approximated as sphere lights bounding their highest detail mesh
+		const hri::Float4& bounds = m_instanceData[meshLOD0].boundingSphere;
+		glm::vec4 worldCenter = modelMatrix * glm::vec4(bounds.x, bounds.y, bounds.z, 1.0f);
+		float maxScale = hri::max(glm::length(glm::vec3(modelMatrix[0])), hri::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+		float radius = bounds.w * maxScale;
+
+		// Irradiance falls off with (r / d)^2, the range is where it drops below the cutoff
+		float range = radius * hri::rsqrtf(LIGHT_INFLUENCE_CUTOFF / maxEmission);
+
+		m_lights.push_back(LightArrayEntry{
+			hri::Float4(worldCenter.x, worldCenter.y, worldCenter.z, radius),
+			hri::Float4(material.emission.x, material.emission.y, material.emission.z, range),
+			modelMatrix,
+			static_cast<uint32_t>(nodeIdx),
+			static_cast<uint32_t>(meshLOD0),
+			static_cast<uint32_t>(meshLOD1),
+			generateLODMask(m_instances.back()),
+			0.0f,
+			0.0f,
+		});
+	}
+
+	// Lights are importance sampled by power, approximated from their emission & bounding sphere cross section
+	float totalPower = 0.0f;
+	for (auto& light : m_lights)
+	{
+		float radius = light.positionRadius.w;
+		light.selectionPdf = (light.emissionRange.x + light.emissionRange.y + light.emissionRange.z) * radius * radius;
+		totalPower += light.selectionPdf;
+	}
+
+	float selectionCdf = 0.0f;
+	for (auto& light : m_lights)
+	{
+		light.selectionPdf /= totalPower;
+		selectionCdf += light.selectionPdf;
+		light.selectionCdf = selectionCdf;
 	}
 
+	if (!m_lights.empty())
+		m_lights.back().selectionCdf = 1.0f;
+
 	return m_instances;
 }
 
@@ -26,6 +26,10 @@ namespace hri
 		HRI_ALIGNAS(16)	Float3 up;
 		HRI_ALIGNAS(16) Float4x4 view;
 		HRI_ALIGNAS(16) Float4x4 project;
+		HRI_ALIGNAS(16) Float4x4 invView;
+		HRI_ALIGNAS(16) Float4x4 invProject;
+		HRI_ALIGNAS(16) Float4x4 viewProject;
+		HRI_ALIGNAS(16) Float4x4 prevViewProject;
 	};
 
 	/// @brief A virtual camera used in rendering operations.
@@ -48,13 +52,19 @@ namespace hri
 		/// @brief Destroy this camera instance.
 		virtual ~Camera() = default;
 
-		/// @brief Update view & project matrices using basis vectors.
+		/// @brief Update view & project matrices using basis vectors, also updates inverse and combined matrices.
 		void updateMatrices();
 
 		/// @brief Retrieve the camera data in a shader ready layout.
+		///		The previous view-project matrix is set to the current view-project matrix.
 		/// @return A Camera Shader Data struct.
 		CameraShaderData getShaderData();
 
+		/// @brief Retrieve the camera data in a shader ready layout.
+		/// @param prevCamera Camera state of the previous frame, used for the previous view-project matrix.
+		/// @return A Camera Shader Data struct.
+		CameraShaderData getShaderData(const Camera& prevCamera);
+
 	public:
 		CameraParameters parameters	= CameraParameters{};
 		Float3 position				= Float3(0.0f);
@@ -63,5 +73,8 @@ namespace hri
 		Float3 up					= HRI_WORLD_UP;
 		Float4x4 view				= Float4x4(1.0f);
 		Float4x4 project			= Float4x4(1.0f);
+		Float4x4 invView			= Float4x4(1.0f);
+		Float4x4 invProject			= Float4x4(1.0f);
+		Float4x4 viewProject		= Float4x4(1.0f);
 	};
 }
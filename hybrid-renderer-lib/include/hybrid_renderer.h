@@ -16,4 +16,5 @@
 #include "renderer_internal/render_pass.h"
 #include "renderer_internal/sampler.h"
 #include "renderer_internal/shader_database.h"
+#include "renderer_internal/shader_pack.h"
 
@@ -39,7 +39,10 @@ namespace hri
 	public:
 		uint32_t vertexCount	= 0;
 		uint32_t indexCount		= 0;
+		Float3 boundsCenter		= Float3(0.0f);	// Local space bounding sphere center
+		float boundsRadius		= 0.0f;			// Local space bounding sphere radius
 		BufferResource vertexBuffer;
+		BufferResource positionBuffer;	// Vertex positions only, deinterleaved for depth only passes
 		BufferResource indexBuffer;
 	};
 }
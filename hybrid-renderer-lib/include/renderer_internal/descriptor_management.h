@@ -1,12 +1,19 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <vector>
 #include <vulkan/vulkan.h>
 
 #include "renderer_internal/render_context.h"
 
 #define HRI_MAX_DESCRIPTOR_SET_COUNT    128
 
+#define HRI_BINDLESS_MAX_SAMPLED_IMAGES     1024
+#define HRI_BINDLESS_MAX_STORAGE_IMAGES     1024
+#define HRI_BINDLESS_MAX_STORAGE_BUFFERS    1024
+#define HRI_BINDLESS_INVALID_INDEX          (~0U)
+
 namespace hri
 {
     /// @brief A Descriptor Set Layout is used to specify bind points for resource descriptors in shaders.
@@ -16,11 +23,13 @@ namespace hri
         /// @param ctx Render context to use.
         /// @param bindings Layout Bindings for this descriptor set.
         /// @param flags Create flags.
+        /// @param bindingFlags Per binding flags, bindings not present in this map use no flags.
         /// @return A new Descriptor Set Layout.
         DescriptorSetLayout(
             RenderContext& ctx,
             std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
-            VkDescriptorSetLayoutCreateFlags flags = 0
+            VkDescriptorSetLayoutCreateFlags flags = 0,
+            std::unordered_map<uint32_t, VkDescriptorBindingFlags> bindingFlags = {}
         );
 
         /// @brief Destroy a descriptor set layout.
@@ -66,8 +75,15 @@ namespace hri
         /// @param type Type of descriptor.
         /// @param shaderStages Shader stages where this descriptor is used.
         /// @param count Number of descriptors in this binding.
+        /// @param bindingFlags Descriptor binding flags, e.g. for partially bound or update after bind bindings.
         /// @return A reference to this class.
-        DescriptorSetLayoutBuilder& addBinding(uint32_t binding, VkDescriptorType type, VkShaderStageFlags shaderStages, uint32_t count = 1);
+        DescriptorSetLayoutBuilder& addBinding(
+            uint32_t binding,
+            VkDescriptorType type,
+            VkShaderStageFlags shaderStages,
+            uint32_t count = 1,
+            VkDescriptorBindingFlags bindingFlags = 0
+        );
 
         /// @brief Set the flags used in descriptor set layout creation.
         /// @param flags Flags to set.
@@ -82,6 +98,7 @@ namespace hri
         RenderContext& m_ctx;
         VkDescriptorSetLayoutCreateFlags m_flags = 0;
         std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> m_bindings = {};
+        std::unordered_map<uint32_t, VkDescriptorBindingFlags> m_bindingFlags = {};
     };
 
     /// @brief The Descriptor Set Allocator handles allocation of Descriptor Sets from descriptor pools.
@@ -207,4 +224,89 @@ namespace hri
         std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> m_bindings = {};
         std::vector<VkWriteDescriptorSet> m_writeSets = {};
     };
+
+    /// @brief Resource types stored in the bindless descriptor set, values match the set bindings.
+    enum class BindlessResourceType
+    {
+        SampledImage = 0,
+        StorageImage = 1,
+        StorageBuffer = 2,
+    };
+
+    /// @brief The Bindless Descriptor Set is a global, update after bind descriptor set containing arrays of
+    ///     sampled images, storage images and storage buffers. Resources stored in it receive a stable index
+    ///     that can be passed to shaders (e.g. through push constants) instead of binding per pass descriptor sets.
+    class BindlessDescriptorSet
+    {
+    public:
+        /// @brief Create a new bindless descriptor set.
+        /// @param ctx Render context to use.
+        /// @param shaderStages Shader stages that may access the bindless set.
+        BindlessDescriptorSet(RenderContext& ctx, VkShaderStageFlags shaderStages = VK_SHADER_STAGE_ALL);
+
+        /// @brief Destroy this bindless descriptor set.
+        virtual ~BindlessDescriptorSet();
+
+        // Disallow copy behaviour
+        BindlessDescriptorSet(const BindlessDescriptorSet&) = delete;
+        BindlessDescriptorSet& operator=(const BindlessDescriptorSet&) = delete;
+
+        // Allow move semantics
+        BindlessDescriptorSet(BindlessDescriptorSet&& other) noexcept;
+        BindlessDescriptorSet& operator=(BindlessDescriptorSet&& other) noexcept;
+
+        /// @brief Store an image descriptor in the bindless set.
+        /// @param type Resource type, must be SampledImage or StorageImage.
+        /// @param imageInfo Image info to write.
+        /// @return A stable index into the resource array for this type.
+        uint32_t storeImage(BindlessResourceType type, const VkDescriptorImageInfo& imageInfo);
+
+        /// @brief Store a storage buffer descriptor in the bindless set.
+        /// @param bufferInfo Buffer info to write.
+        /// @return A stable index into the storage buffer array.
+        uint32_t storeBuffer(const VkDescriptorBufferInfo& bufferInfo);
+
+        /// @brief Overwrite a previously stored image descriptor, keeping its index.
+        /// @param type Resource type, must be SampledImage or StorageImage.
+        /// @param index Index returned by storeImage.
+        /// @param imageInfo Image info to write.
+        void updateImage(BindlessResourceType type, uint32_t index, const VkDescriptorImageInfo& imageInfo);
+
+        /// @brief Overwrite a previously stored buffer descriptor, keeping its index.
+        /// @param index Index returned by storeBuffer.
+        /// @param bufferInfo Buffer info to write.
+        void updateBuffer(uint32_t index, const VkDescriptorBufferInfo& bufferInfo);
+
+        /// @brief Free a stored resource index, allowing it to be reused by new resources.
+        ///     The descriptor is left as-is, shaders must no longer access the freed index.
+        /// @param type Resource type of the index.
+        /// @param index Index to free.
+        void free(BindlessResourceType type, uint32_t index);
+
+    private:
+        /// @brief Release resources held by this class.
+        void release();
+
+        /// @brief Allocate a new index for a resource type.
+        /// @param type Resource type to allocate for.
+        /// @return A new index.
+        uint32_t allocateIndex(BindlessResourceType type);
+
+    public:
+        std::unique_ptr<DescriptorSetLayout> layout;
+        VkDescriptorSet set = VK_NULL_HANDLE;
+
+    private:
+        /// @brief Index allocation state per resource type.
+        struct IndexAllocator
+        {
+            uint32_t capacity = 0;
+            uint32_t nextIndex = 0;
+            std::vector<uint32_t> freeList = {};
+        };
+
+        RenderContext& m_ctx;
+        VkDescriptorPool m_pool = VK_NULL_HANDLE;
+        IndexAllocator m_allocators[3] = {};
+    };
 }
@@ -16,8 +16,15 @@ namespace hri
 	{
 		Color,
 		DepthStencil,
+		Input,	// Read in a later subpass through subpassLoad, keeps data on-tile where supported
 	};
 
+	/// @brief Get a grow only allocation extent with some headroom, so continuous resizes rarely reallocate.
+	/// @param extent Extent that must fit in the allocation.
+	/// @param allocatedExtent Currently allocated extent, the result never shrinks below it.
+	/// @return The extent to allocate.
+	VkExtent2D overallocateExtent(VkExtent2D extent, VkExtent2D allocatedExtent);
+
 	/// @brief The RenderPassBuilder allows for easy setup of render passes.
 	class RenderPassBuilder
 	{
@@ -50,6 +57,15 @@ namespace hri
 			VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
 		);
 
+		/// @brief Add a dependency between subpasses.
+		/// @param srcSubpass Source subpass index, or VK_SUBPASS_EXTERNAL.
+		/// @param dstSubpass Destination subpass index, or VK_SUBPASS_EXTERNAL.
+		/// @param srcStageMask 
+		/// @param dstStageMask 
+		/// @param srcAccessMask 
+		/// @param dstAccessMask 
+		/// @param flags Dependency flags, use VK_DEPENDENCY_BY_REGION_BIT for per pixel (input attachment) dependencies.
+		/// @return RenderPassBuilder reference.
 		RenderPassBuilder& addDependency(
 			uint32_t srcSubpass,
 			uint32_t dstSubpass,
@@ -78,6 +94,7 @@ namespace hri
 		struct SubpassData
 		{
 			std::vector<VkAttachmentReference> colorAttachments;
+			std::vector<VkAttachmentReference> inputAttachments;
 			std::optional<VkAttachmentReference> depthStencilAttachment;
 		};
 
@@ -93,8 +110,9 @@ namespace hri
 	{
 		VkFormat format;
 		VkSampleCountFlagBits samples;
-		VkImageUsageFlags usage;
+		VkImageUsageFlags usage;	// Transient attachment usage allocates lazily where supported
 		VkImageAspectFlags aspect;
+		uint32_t layers = 1;	// Attachments with multiple layers are created as 2D array images
 	};
 
 	/// @brief The Render Pass Resource Manager Base is used to create and recreate render pass resources.
@@ -145,6 +163,12 @@ namespace hri
 			return m_imageResources[attachmentIndex];
 		}
 
+		/// @brief Get a view of a single layer of a managed attachment resource.
+		/// @param attachmentIndex Attachment resource index to retrieve.
+		/// @param layer Attachment layer to retrieve.
+		/// @return A 2D image view of the attachment layer.
+		virtual VkImageView getAttachmentLayerView(uint32_t attachmentIndex, uint32_t layer) const;
+
 		/// @brief Recreate resources.
 		inline virtual void recreateResources() {
 			destroyResources();
@@ -166,6 +190,10 @@ namespace hri
 		/// @return The render extent.
 		virtual VkExtent2D getRenderExtent() const;
 
+		/// @brief Get the framebuffer layer count required by the attachment configs.
+		/// @return The largest attachment layer count.
+		virtual uint32_t getFramebufferLayers() const;
+
 	protected:
 		RenderContext& m_ctx;
 		VkRenderPass m_renderPass = VK_NULL_HANDLE;
@@ -173,6 +201,7 @@ namespace hri
 		std::vector<VkClearValue> m_clearValues = {};
 		std::vector<RenderAttachmentConfig> m_attachmentConfigs = {};
 		std::vector<ImageResource> m_imageResources = {};
+		std::vector<std::vector<VkImageView>> m_layerViews = {};
 	};
 
 	/// @brief The Swapchain pass resource manager is a special type of resource manager that handles rendering
@@ -235,6 +264,11 @@ namespace hri
 		/// @param frame Active Frame to record into.
 		virtual void beginRenderPass(ActiveFrame& frame) const override;
 
+		/// @brief Begin a render pass compatible with the managed render pass, rendering into the offscreen framebuffer.
+		/// @param frame Active Frame to record into.
+		/// @param renderPass Compatible render pass, e.g. one that loads instead of clears the attachments.
+		virtual void beginRenderPass(ActiveFrame& frame, VkRenderPass renderPass) const;
+
 	protected:
 		/// @brief Create resources.
 		virtual void createResources() override;
@@ -245,4 +279,83 @@ namespace hri
 	private:
 		VkFramebuffer m_framebuffer = VK_NULL_HANDLE;
 	};
+
+	/// @brief The Dynamic Rendering Attachment Info describes how an attachment is rendered to without a render pass.
+	struct DynamicRenderingAttachmentInfo
+	{
+		AttachmentType type;	// Color or DepthStencil, input attachments are not supported in dynamic rendering
+		VkAttachmentLoadOp loadOp;
+		VkAttachmentStoreOp storeOp;
+		VkImageLayout finalLayout;	// Layout the attachment is transitioned to after rendering
+	};
+
+	/// @brief The Dynamic Rendering Resource Manager renders into its attachments using dynamic rendering, no render pass
+	///		or framebuffer objects are created. Attachments are over-allocated & only grow, resizing within the allocated
+	///		extent only changes the render area. Attachments MUST be read using texel coordinates.
+	class DynamicRenderingResourceManager
+		:
+		public IRenderPassResourceManagerBase
+	{
+	public:
+		/// @brief Create a new Dynamic Rendering Resource Manager.
+		/// @param ctx Render Context to use.
+		/// @param attachmentInfos Rendering info for each attachment, the swap image is attachment 0 if rendering to the swapchain.
+		/// @param attachmentConfigs Pass attachment configs for managed attachments.
+		/// @param swapchainTarget Render into the active swap image as the first color attachment.
+		DynamicRenderingResourceManager(
+			RenderContext& ctx,
+			const std::vector<DynamicRenderingAttachmentInfo>& attachmentInfos,
+			const std::vector<RenderAttachmentConfig>& attachmentConfigs = {},
+			bool swapchainTarget = false
+		);
+
+		/// @brief Destroy this resource manager.
+		virtual ~DynamicRenderingResourceManager();
+
+		/// @brief Begin dynamic rendering, transitioning attachments to their attachment layouts.
+		/// @param frame Active Frame to record into.
+		virtual void beginRenderPass(ActiveFrame& frame) const override;
+
+		/// @brief End dynamic rendering, transitioning attachments to their final layouts.
+		/// @param frame Active Frame to record into.
+		virtual void endRenderPass(ActiveFrame& frame) const override;
+
+		/// @brief Recreate resources, managed attachments are only reallocated if the render extent outgrows them.
+		virtual void recreateResources() override;
+
+		/// @brief Retrieve the current render area extent.
+		/// @return The render extent.
+		inline VkExtent2D renderExtent() const { return m_renderExtent; }
+
+	protected:
+		/// @brief Create resources.
+		virtual void createResources() override;
+
+		/// @brief Destroy resources.
+		virtual void destroyResources() override;
+
+		/// @brief Get the over-allocated extent needed to fit the current swapchain extent.
+		/// @return The allocation extent.
+		virtual VkExtent2D getRenderExtent() const override;
+
+	private:
+		/// @brief Record layout transitions for all attachments.
+		/// @param frame Active Frame to record into.
+		/// @param beginRendering Transition to attachment layouts if true, to final layouts otherwise.
+		void transitionAttachments(ActiveFrame& frame, bool beginRendering) const;
+
+		/// @brief Create swap image views if rendering to the swapchain.
+		void createSwapViews();
+
+		/// @brief Destroy swap image views.
+		void destroySwapViews();
+
+	private:
+		bool m_swapchainTarget = false;
+		VkExtent2D m_allocatedExtent = VkExtent2D{};
+		std::vector<DynamicRenderingAttachmentInfo> m_attachmentInfos = {};
+		std::vector<VkImage> m_swapImages = {};
+		std::vector<VkImageView> m_swapViews = {};
+		mutable std::vector<VkImageLayout> m_attachmentLayouts = {};	// Tracked for managed attachments loaded from previous frames
+	};
 }
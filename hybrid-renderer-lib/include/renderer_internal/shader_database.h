@@ -1,5 +1,7 @@
 #pragma once
 
+#include <future>
+#include <memory>
 #include <string>
 #include <map>
 #include <vector>
@@ -7,6 +9,7 @@
 
 #include "renderer_internal/render_context.h"
 #include "renderer_internal/descriptor_management.h"
+#include "renderer_internal/shader_pack.h"
 
 #define HRI_SHADER_DB_BUILTIN_NAME(name) ("Builtin::" name)
 
@@ -69,6 +72,8 @@ namespace hri
         VkPipelineLayout layout;
         VkRenderPass renderPass;
         uint32_t subpass;
+        std::vector<VkFormat> colorAttachmentFormats;   // Dynamic rendering formats, used if renderPass is VK_NULL_HANDLE
+        VkFormat depthAttachmentFormat;
 
         static VkPipelineInputAssemblyStateCreateInfo initInputAssemblyState(VkPrimitiveTopology topology, VkBool32 primitiveRestart);
 
@@ -83,6 +88,8 @@ namespace hri
         static VkPipelineDepthStencilStateCreateInfo initDepthStencilState(VkBool32 depthTest, VkBool32 depthWrite, VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS);
 
         static VkPipelineColorBlendStateCreateInfo initColorBlendState(const std::vector<VkPipelineColorBlendAttachmentState>& attachments);
+
+        static VkPipelineRenderingCreateInfo initRenderingCreateInfo(const std::vector<VkFormat>& colorFormats, VkFormat depthFormat);
     };
 
     /// @brief A Shader object represents a programmable pipeline stage.
@@ -114,6 +121,13 @@ namespace hri
         /// @return a new Shader object.
         static Shader loadFile(RenderContext& ctx, const std::string& path, VkShaderStageFlagBits stage);
 
+        /// @brief Load a SPIR-V shader from a mapped shader pack, the module is created directly from the mapped memory.
+        /// @param ctx Render Context to use.
+        /// @param pack Shader pack to load from.
+        /// @param entryName Shader pack entry name.
+        /// @return a new Shader object.
+        static Shader loadPacked(RenderContext& ctx, const ShaderPack& pack, const std::string& entryName);
+
     private:
         /// @brief Release this shaders resources.
         void release();
@@ -121,6 +135,7 @@ namespace hri
     public:
         VkShaderStageFlagBits stage = VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
         VkShaderModule module       = VK_NULL_HANDLE;
+        uint64_t hash               = 0;    // SPIR-V content hash, usable as pipeline variant key
 
     protected:
         RenderContext& m_ctx;
@@ -141,6 +156,12 @@ namespace hri
         /// @param ctx Render Context to use.
         ShaderDatabase(RenderContext& ctx);
 
+        /// @brief Create a new Shader Database backed by a shader pack.
+        ///     The pipeline cache is persisted next to the pack, keyed by the pack content hash.
+        /// @param ctx Render Context to use.
+        /// @param shaderPackPath Path of the shader pack to map.
+        ShaderDatabase(RenderContext& ctx, const std::string& shaderPackPath);
+
         /// @brief Destroy this Shader Database instance.
         virtual ~ShaderDatabase();
 
@@ -154,6 +175,12 @@ namespace hri
         /// @return A pointer to the Shader in the Shader Database.
         Shader* registerShader(const std::string& name, Shader&& shader);
 
+        /// @brief Register a Shader from the Shader Database's shader pack.
+        /// @param name Shader name to use. MUST be unique.
+        /// @param packEntryName Shader pack entry to load, the source file name of the shader (e.g. "static.vert").
+        /// @return A pointer to the Shader in the Shader Database.
+        Shader* registerShader(const std::string& name, const std::string& packEntryName);
+
         /// @brief Create a new graphics pipeline object in the Shader Database.
         /// @param name Pipeline name to use. MUST be unique.
         /// @param shaders Shader names to use.
@@ -165,15 +192,56 @@ namespace hri
             const GraphicsPipelineBuilder& pipelineBuilder
         );
 
+        /// @brief Create a new graphics pipeline library in the Shader Database, containing only the requested pipeline parts.
+        ///     Shaders not belonging to the requested parts are ignored.
+        /// @param name Library name to use, an existing library with this name is returned instead.
+        /// @param libraryParts Graphics pipeline library parts to compile into this library.
+        /// @param shaders Shader names to use.
+        /// @param pipelineBuilder Pipeline Builder object to use for initialization.
+        /// @return A pointer to the Pipeline Library in the Shader Database.
+        PipelineStateObject* createPipelineLibrary(
+            const std::string& name,
+            VkGraphicsPipelineLibraryFlagsEXT libraryParts,
+            const std::vector<std::string>& shaders,
+            const GraphicsPipelineBuilder& pipelineBuilder
+        );
+
+        /// @brief Link graphics pipeline libraries into a new graphics pipeline object in the Shader Database.
+        /// @param name Pipeline name to use. MUST be unique.
+        /// @param libraries Pipeline library names to link, together these MUST contain all graphics pipeline library parts.
+        /// @param layout Pipeline Layout to use for this pipeline.
+        /// @param linkTimeOptimization Optimize the linked pipeline, slower to link but results in faster pipelines.
+        ///     Pipelines linked without optimization are relinked by `optimizeLinkedPipelines()`.
+        /// @return A pointer to the Pipeline in the Shader Database.
+        PipelineStateObject* linkPipeline(
+            const std::string& name,
+            const std::vector<std::string>& libraries,
+            VkPipelineLayout layout,
+            bool linkTimeOptimization = false
+        );
+
+        /// @brief Start relinking all unoptimized linked pipelines with link time optimization on a background thread.
+        ///     Does nothing if a relink is already in progress or no unoptimized pipelines exist.
+        void optimizeLinkedPipelines();
+
+        /// @brief Swap in the optimized pipelines once the background relink has finished, does not block.
+        ///     Replaced pipelines may still be used by frames in flight, so they are destroyed once `HRI_VK_FRAMES_IN_FLIGHT` frames have passed.
+        ///     A new relink is started for pipelines that were linked after the previous relink started.
+        /// @param frameIndex Index of the frame about to be recorded, MUST increase by one every frame.
+        /// @return A boolean indicating if pipelines were swapped.
+        bool swapOptimizedPipelines(uint64_t frameIndex);
+
         /// @brief Create a new compute pipeline object in the Shader Database.
         /// @param name Pipeline name to use. MUST be unique.
         /// @param computeShader Compute Shader used by this pipeline.
         /// @prarm layout Pipeline Layout to use for this pipeline.
+        /// @param pSpecializationInfo Optional specialization constants for the compute shader.
         /// @return A pointer to the Pipeline in the Shader Database.
         PipelineStateObject* createPipeline(
             const std::string& name,
             const std::string& computeShader,
-            VkPipelineLayout layout
+            VkPipelineLayout layout,
+            const VkSpecializationInfo* pSpecializationInfo = nullptr
         );
 
         /// @brief Register a pipeline with the Shader Database.
@@ -201,7 +269,23 @@ namespace hri
         /// @return The pipeline cache used for this shader database.
         inline VkPipelineCache pipelineCache() const { return m_pipelineCache; }
 
+        /// @brief Get the shader pack used by this shader database.
+        /// @return A pointer to the shader pack, or nullptr if no pack is used.
+        inline const ShaderPack* shaderPack() const { return m_shaderPack.get(); }
+
     private:
+        /// @brief Create the pipeline cache, optionally loading initial data from a file.
+        /// @param cachePath Pipeline cache file path, empty for no initial data.
+        void createPipelineCache(const std::string& cachePath);
+
+        /// @brief Write the pipeline cache data to a file.
+        /// @param cachePath Pipeline cache file path.
+        void savePipelineCache(const std::string& cachePath) const;
+
+        /// @brief Remove pipeline cache files of previous shader packs next to the active cache file.
+        /// @param cachePath Active pipeline cache file path, this file is kept.
+        void removeStalePipelineCaches(const std::string& cachePath) const;
+
         /// @brief Check if a Shader already exists in the Database.
         /// @param name Shader name to check.
         /// @return A boolean to indicate existence.
@@ -212,10 +296,43 @@ namespace hri
         /// @return A boolean to indicate existence.
         bool isExistingPipeline(const std::string& name) const;
 
+        /// @brief Create a graphics pipeline from linked pipeline libraries.
+        /// @param libraryHandles Pipeline library handles to link.
+        /// @param layout Pipeline Layout to use for this pipeline.
+        /// @param linkTimeOptimization Optimize the linked pipeline.
+        /// @return The new pipeline handle.
+        VkPipeline createLinkedPipeline(
+            const std::vector<VkPipeline>& libraryHandles,
+            VkPipelineLayout layout,
+            bool linkTimeOptimization
+        ) const;
+
+    private:
+        /// @brief Fast linked pipeline awaiting an optimized relink.
+        struct UnoptimizedLink
+        {
+            std::string name                        = {};
+            std::vector<VkPipeline> libraryHandles  = {};
+            VkPipelineLayout layout                 = VK_NULL_HANDLE;
+            VkPipeline optimizedPipeline            = VK_NULL_HANDLE;
+        };
+
+        /// @brief Replaced pipeline awaiting destruction once no frame in flight can use it anymore.
+        struct RetiredPipeline
+        {
+            VkPipeline pipeline                     = VK_NULL_HANDLE;
+            uint64_t retireFrame                    = 0;
+        };
+
     private:
         RenderContext& m_ctx;
         VkPipelineCache m_pipelineCache                             = VK_NULL_HANDLE;
+        std::unique_ptr<ShaderPack> m_shaderPack                    = nullptr;
+        std::string m_pipelineCachePath                             = {};
         std::map<std::string, Shader> m_shaderMap                   = {};
         std::map<std::string, PipelineStateObject> m_pipelineMap    = {};
+        std::vector<UnoptimizedLink> m_unoptimizedLinks             = {};
+        std::future<std::vector<UnoptimizedLink>> m_optimizeTask    = {};
+        std::vector<RetiredPipeline> m_retiredPipelines             = {};
     };
 }
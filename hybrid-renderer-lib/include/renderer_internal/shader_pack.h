@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vulkan/vulkan.h>
+
+#include "platform.h"
+
+#define HRI_SHADER_PACK_MAGIC           0x4B505348  // "HSPK"
+#define HRI_SHADER_PACK_VERSION         1
+#define HRI_SHADER_PACK_MAX_NAME_LENGTH 64
+#define HRI_SHADER_PACK_CODE_ALIGNMENT  16
+
+#define HRI_FNV1A_64_OFFSET_BASIS       0xCBF29CE484222325ULL
+#define HRI_FNV1A_64_PRIME              0x00000100000001B3ULL
+
+namespace hri
+{
+    /// @brief Hash a block of data using 64 bit FNV-1a.
+    /// @param pData Data to hash.
+    /// @param size Size of the data in bytes.
+    /// @param seed Hash seed, allows chaining multiple blocks into one hash.
+    /// @return A 64 bit hash.
+    inline uint64_t fnv1a64(const void* pData, size_t size, uint64_t seed = HRI_FNV1A_64_OFFSET_BASIS)
+    {
+        const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+        uint64_t hash = seed;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= static_cast<uint64_t>(pBytes[i]);
+            hash *= HRI_FNV1A_64_PRIME;
+        }
+
+        return hash;
+    }
+
+    /// @brief Shader pack file header, followed by the entry index & SPIR-V code blocks.
+    struct ShaderPackHeader
+    {
+        uint32_t magic          = HRI_SHADER_PACK_MAGIC;
+        uint32_t version        = HRI_SHADER_PACK_VERSION;
+        uint32_t entryCount     = 0;
+        uint32_t reserved       = 0;
+        uint64_t packHash       = 0;    // Hash of all entry names, stages & hashes, changes when any shader changes
+    };
+
+    /// @brief Shader pack index entry, offsets are relative to the start of the pack file.
+    struct ShaderPackEntry
+    {
+        char name[HRI_SHADER_PACK_MAX_NAME_LENGTH]  = {};
+        uint32_t stage                              = 0;    // VkShaderStageFlagBits
+        uint32_t codeSize                           = 0;
+        uint64_t codeOffset                         = 0;
+        uint64_t hash                               = 0;    // FNV-1a hash of the SPIR-V code
+    };
+
+    /// @brief A Shader Pack is a single memory mapped file containing all SPIR-V shaders of an application.
+    class ShaderPack
+    {
+    public:
+        /// @brief Map a shader pack file into memory.
+        /// @param path Path of the shader pack file.
+        ShaderPack(const std::string& path);
+
+        /// @brief Unmap this shader pack.
+        virtual ~ShaderPack();
+
+        // Disallow copy behaviour
+        ShaderPack(const ShaderPack&) = delete;
+        ShaderPack& operator=(const ShaderPack&) = delete;
+
+        // Allow move semantics
+        ShaderPack(ShaderPack&& other) noexcept;
+        ShaderPack& operator=(ShaderPack&& other) noexcept;
+
+        /// @brief Find a shader entry in this pack.
+        /// @param name Entry name, the source file name of the shader (e.g. "static.vert").
+        /// @return A pointer to the entry, or nullptr if it does not exist.
+        const ShaderPackEntry* findEntry(const std::string& name) const;
+
+        /// @brief Get the SPIR-V code of an entry, this points directly into the mapped pack.
+        /// @param entry Entry to retrieve the code for.
+        /// @return A pointer to the SPIR-V code.
+        const uint32_t* code(const ShaderPackEntry& entry) const;
+
+        /// @brief Get the pack content hash.
+        /// @return The hash of all shaders in this pack.
+        inline uint64_t packHash() const { return header()->packHash; }
+
+    private:
+        /// @brief Release this shader pack's mapping.
+        void release();
+
+        /// @brief Get the pack header from the mapped data.
+        inline const ShaderPackHeader* header() const { return static_cast<const ShaderPackHeader*>(m_pData); }
+
+    private:
+        const void* m_pData = nullptr;
+        size_t m_size       = 0;
+        std::unordered_map<std::string, const ShaderPackEntry*> m_entries = {};
+    };
+}
@@ -31,9 +31,18 @@ void Camera::updateMatrices()
 	project = perspective(radians(parameters.fovYDegrees), parameters.aspectRatio, parameters.zNear, parameters.zFar);
 
 	project[1][1] *= -1;	// Flip Y to account for viewport flip
+
+	invView = inverse(view);
+	invProject = inverse(project);
+	viewProject = project * view;
 }
 
 CameraShaderData Camera::getShaderData()
+{
+	return getShaderData(*this);
+}
+
+CameraShaderData Camera::getShaderData(const Camera& prevCamera)
 {
 	return CameraShaderData{
 		position,
@@ -42,5 +51,9 @@ CameraShaderData Camera::getShaderData()
 		up,
 		view,
 		project,
+		invView,
+		invProject,
+		viewProject,
+		prevCamera.viewProject,
 	};
 }
@@ -1,5 +1,6 @@
 #include "mesh.h"
 
+#include <cfloat>
 #include <cstdint>
 #include <vector>
 
@@ -15,16 +16,43 @@ Mesh::Mesh(RenderContext& ctx, const std::vector<Vertex>& vertices, const std::v
 	vertexCount(static_cast<uint32_t>(vertices.size())),
 	indexCount(static_cast<uint32_t>(indices.size())),
 	vertexBuffer(ctx, sizeof(Vertex) * vertices.size(), bufferFlags | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT),
+	positionBuffer(ctx, sizeof(Float3) * vertices.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT),
 	indexBuffer(ctx, sizeof(uint32_t) * indices.size(), bufferFlags | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT)
 {
+	// Calculate bounding sphere around the vertex AABB
+	glm::vec3 minBound = glm::vec3(FLT_MAX);
+	glm::vec3 maxBound = glm::vec3(-FLT_MAX);
+	for (auto const& vertex : vertices)
+	{
+		minBound = glm::min(minBound, static_cast<glm::vec3>(vertex.position));
+		maxBound = glm::max(maxBound, static_cast<glm::vec3>(vertex.position));
+	}
+
+	glm::vec3 center = 0.5f * (minBound + maxBound);
+	for (auto const& vertex : vertices)
+	{
+		boundsRadius = hri::max(boundsRadius, glm::distance(center, static_cast<glm::vec3>(vertex.position)));
+	}
+
+	boundsCenter = Float3(center.x, center.y, center.z);
+
 	CommandPool pool = CommandPool(ctx, ctx.queues.transferQueue);
 
 	BufferResource stagingVertex = BufferResource(ctx, vertexBuffer.bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
+	BufferResource stagingPosition = BufferResource(ctx, positionBuffer.bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
 	BufferResource stagingIndex = BufferResource(ctx, indexBuffer.bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, true);
 
 	stagingVertex.copyToBuffer(vertices.data(), vertexBuffer.bufferSize);
 	stagingIndex.copyToBuffer(indices.data(), indexBuffer.bufferSize);
 
+	// Deinterleave positions while the vertex data is still on the host
+	Float3* pPositions = static_cast<Float3*>(stagingPosition.map());
+	for (size_t vertexIdx = 0; vertexIdx < vertices.size(); vertexIdx++)
+	{
+		pPositions[vertexIdx] = vertices[vertexIdx].position;
+	}
+	stagingPosition.unmap();
+
 	VkCommandBuffer commandBuffer = pool.createCommandBuffer(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 
 	VkBufferCopy vertexCopy = VkBufferCopy{};
@@ -32,12 +60,18 @@ Mesh::Mesh(RenderContext& ctx, const std::vector<Vertex>& vertices, const std::v
 	vertexCopy.dstOffset = 0;
 	vertexCopy.size = vertexBuffer.bufferSize;
 
+	VkBufferCopy positionCopy = VkBufferCopy{};
+	positionCopy.srcOffset = 0;
+	positionCopy.dstOffset = 0;
+	positionCopy.size = positionBuffer.bufferSize;
+
 	VkBufferCopy indexCopy = VkBufferCopy{};
 	indexCopy.srcOffset = 0;
 	indexCopy.dstOffset = 0;
 	indexCopy.size = indexBuffer.bufferSize;
 
 	vkCmdCopyBuffer(commandBuffer, stagingVertex.buffer, vertexBuffer.buffer, 1, &vertexCopy);
+	vkCmdCopyBuffer(commandBuffer, stagingPosition.buffer, positionBuffer.buffer, 1, &positionCopy);
 	vkCmdCopyBuffer(commandBuffer, stagingIndex.buffer, indexBuffer.buffer, 1, &indexCopy);
 
 	pool.submitAndWait(commandBuffer);
@@ -1,5 +1,7 @@
 #include "renderer_internal/descriptor_management.h"
 
+#include <cassert>
+#include <cstdio>
 #include <map>
 #include <vulkan/vulkan.h>
 
@@ -10,19 +12,28 @@ using namespace hri;
 DescriptorSetLayout::DescriptorSetLayout(
     RenderContext& ctx,
     std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
-    VkDescriptorSetLayoutCreateFlags flags
+    VkDescriptorSetLayoutCreateFlags flags,
+    std::unordered_map<uint32_t, VkDescriptorBindingFlags> bindingFlags
 )
     :
     m_ctx(ctx),
     m_bindings(bindings)
 {
     std::vector<VkDescriptorSetLayoutBinding> setBindings; setBindings.reserve(bindings.size());
+    std::vector<VkDescriptorBindingFlags> setBindingFlags; setBindingFlags.reserve(bindings.size());
     for (auto const& [ bindingIdx, binding ] : bindings)
     {
+        auto const& flagsIt = bindingFlags.find(bindingIdx);
         setBindings.push_back(binding);
+        setBindingFlags.push_back(flagsIt != bindingFlags.end() ? flagsIt->second : 0);
     }
 
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = VkDescriptorSetLayoutBindingFlagsCreateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO };
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(setBindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = setBindingFlags.data();
+
     VkDescriptorSetLayoutCreateInfo createInfo = VkDescriptorSetLayoutCreateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    createInfo.pNext = bindingFlags.empty() ? nullptr : &bindingFlagsInfo;
     createInfo.flags = flags;
     createInfo.bindingCount = static_cast<uint32_t>(setBindings.size());
     createInfo.pBindings = setBindings.data();
@@ -72,7 +83,13 @@ DescriptorSetLayoutBuilder::DescriptorSetLayoutBuilder(RenderContext& ctx)
     //
 }
 
-DescriptorSetLayoutBuilder& DescriptorSetLayoutBuilder::addBinding(uint32_t binding, VkDescriptorType type, VkShaderStageFlags shaderStages, uint32_t count)
+DescriptorSetLayoutBuilder& DescriptorSetLayoutBuilder::addBinding(
+    uint32_t binding,
+    VkDescriptorType type,
+    VkShaderStageFlags shaderStages,
+    uint32_t count,
+    VkDescriptorBindingFlags bindingFlags
+)
 {
     VkDescriptorSetLayoutBinding layoutBinding = VkDescriptorSetLayoutBinding{};
     layoutBinding.binding = binding;
@@ -82,6 +99,15 @@ DescriptorSetLayoutBuilder& DescriptorSetLayoutBuilder::addBinding(uint32_t bind
     layoutBinding.pImmutableSamplers = nullptr;
     m_bindings.insert_or_assign(binding, layoutBinding);
 
+    if (bindingFlags != 0)
+    {
+        m_bindingFlags.insert_or_assign(binding, bindingFlags);
+    }
+    else
+    {
+        m_bindingFlags.erase(binding);
+    }
+
     return *this;
 }
 
@@ -94,7 +120,7 @@ DescriptorSetLayoutBuilder& DescriptorSetLayoutBuilder::setDescriptorSetFlags(Vk
 
 DescriptorSetLayout DescriptorSetLayoutBuilder::build()
 {
-    return DescriptorSetLayout(m_ctx, m_bindings, m_flags);
+    return DescriptorSetLayout(m_ctx, m_bindings, m_flags, m_bindingFlags);
 }
 
 DescriptorSetAllocator::DescriptorSetAllocator(RenderContext& ctx)
@@ -294,3 +320,176 @@ const VkDescriptorSetLayoutBinding& DescriptorSetManager::getLayoutBinding(uint3
 
     return it->second;
 }
+
+BindlessDescriptorSet::BindlessDescriptorSet(RenderContext& ctx, VkShaderStageFlags shaderStages)
+    :
+    m_ctx(ctx)
+{
+    const VkDescriptorBindingFlags bindlessFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+        | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+        | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+    m_allocators[static_cast<size_t>(BindlessResourceType::SampledImage)].capacity = HRI_BINDLESS_MAX_SAMPLED_IMAGES;
+    m_allocators[static_cast<size_t>(BindlessResourceType::StorageImage)].capacity = HRI_BINDLESS_MAX_STORAGE_IMAGES;
+    m_allocators[static_cast<size_t>(BindlessResourceType::StorageBuffer)].capacity = HRI_BINDLESS_MAX_STORAGE_BUFFERS;
+
+    DescriptorSetLayoutBuilder layoutBuilder(m_ctx);
+    layoutBuilder
+        .addBinding(static_cast<uint32_t>(BindlessResourceType::SampledImage), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, shaderStages, HRI_BINDLESS_MAX_SAMPLED_IMAGES, bindlessFlags)
+        .addBinding(static_cast<uint32_t>(BindlessResourceType::StorageImage), VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, shaderStages, HRI_BINDLESS_MAX_STORAGE_IMAGES, bindlessFlags)
+        .addBinding(static_cast<uint32_t>(BindlessResourceType::StorageBuffer), VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, shaderStages, HRI_BINDLESS_MAX_STORAGE_BUFFERS, bindlessFlags)
+        .setDescriptorSetFlags(VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT);
+
+    layout = std::make_unique<DescriptorSetLayout>(layoutBuilder.build());
+
+    // Bindless set needs its own update after bind pool, it cannot be allocated from the regular set allocator
+    std::vector<VkDescriptorPoolSize> poolSizes = {
+        VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, HRI_BINDLESS_MAX_SAMPLED_IMAGES },
+        VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, HRI_BINDLESS_MAX_STORAGE_IMAGES },
+        VkDescriptorPoolSize{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, HRI_BINDLESS_MAX_STORAGE_BUFFERS },
+    };
+
+    VkDescriptorPoolCreateInfo poolCreateInfo = VkDescriptorPoolCreateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO };
+    poolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolCreateInfo.maxSets = 1;
+    poolCreateInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolCreateInfo.pPoolSizes = poolSizes.data();
+    HRI_VK_CHECK(vkCreateDescriptorPool(m_ctx.device, &poolCreateInfo, nullptr, &m_pool));
+
+    VkDescriptorSetAllocateInfo allocateInfo = VkDescriptorSetAllocateInfo{ VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO };
+    allocateInfo.descriptorPool = m_pool;
+    allocateInfo.descriptorSetCount = 1;
+    allocateInfo.pSetLayouts = &layout->setLayout;
+    HRI_VK_CHECK(vkAllocateDescriptorSets(m_ctx.device, &allocateInfo, &set));
+}
+
+BindlessDescriptorSet::~BindlessDescriptorSet()
+{
+    release();
+}
+
+BindlessDescriptorSet::BindlessDescriptorSet(BindlessDescriptorSet&& other) noexcept
+    :
+    layout(std::move(other.layout)),
+    set(other.set),
+    m_ctx(other.m_ctx),
+    m_pool(other.m_pool)
+{
+    for (size_t i = 0; i < HRI_SIZEOF_ARRAY(m_allocators); i++)
+    {
+        m_allocators[i] = std::move(other.m_allocators[i]);
+    }
+
+    other.set = VK_NULL_HANDLE;
+    other.m_pool = VK_NULL_HANDLE;
+}
+
+BindlessDescriptorSet& BindlessDescriptorSet::operator=(BindlessDescriptorSet&& other) noexcept
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    release();
+    layout = std::move(other.layout);
+    set = other.set;
+    m_ctx = std::move(other.m_ctx);
+    m_pool = other.m_pool;
+
+    for (size_t i = 0; i < HRI_SIZEOF_ARRAY(m_allocators); i++)
+    {
+        m_allocators[i] = std::move(other.m_allocators[i]);
+    }
+
+    other.set = VK_NULL_HANDLE;
+    other.m_pool = VK_NULL_HANDLE;
+
+    return *this;
+}
+
+uint32_t BindlessDescriptorSet::storeImage(BindlessResourceType type, const VkDescriptorImageInfo& imageInfo)
+{
+    uint32_t index = allocateIndex(type);
+    updateImage(type, index, imageInfo);
+
+    return index;
+}
+
+uint32_t BindlessDescriptorSet::storeBuffer(const VkDescriptorBufferInfo& bufferInfo)
+{
+    uint32_t index = allocateIndex(BindlessResourceType::StorageBuffer);
+    updateBuffer(index, bufferInfo);
+
+    return index;
+}
+
+void BindlessDescriptorSet::updateImage(BindlessResourceType type, uint32_t index, const VkDescriptorImageInfo& imageInfo)
+{
+    assert(type == BindlessResourceType::SampledImage || type == BindlessResourceType::StorageImage);
+    assert(index < m_allocators[static_cast<size_t>(type)].nextIndex);
+
+    const VkDescriptorSetLayoutBinding& layoutBinding = layout->bindings().at(static_cast<uint32_t>(type));
+
+    VkWriteDescriptorSet writeSet = VkWriteDescriptorSet{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    writeSet.dstSet = set;
+    writeSet.dstBinding = layoutBinding.binding;
+    writeSet.dstArrayElement = index;
+    writeSet.descriptorCount = 1;
+    writeSet.descriptorType = layoutBinding.descriptorType;
+    writeSet.pImageInfo = &imageInfo;
+
+    vkUpdateDescriptorSets(m_ctx.device, 1, &writeSet, 0, nullptr);
+}
+
+void BindlessDescriptorSet::updateBuffer(uint32_t index, const VkDescriptorBufferInfo& bufferInfo)
+{
+    assert(index < m_allocators[static_cast<size_t>(BindlessResourceType::StorageBuffer)].nextIndex);
+
+    const VkDescriptorSetLayoutBinding& layoutBinding = layout->bindings().at(static_cast<uint32_t>(BindlessResourceType::StorageBuffer));
+
+    VkWriteDescriptorSet writeSet = VkWriteDescriptorSet{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET };
+    writeSet.dstSet = set;
+    writeSet.dstBinding = layoutBinding.binding;
+    writeSet.dstArrayElement = index;
+    writeSet.descriptorCount = 1;
+    writeSet.descriptorType = layoutBinding.descriptorType;
+    writeSet.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(m_ctx.device, 1, &writeSet, 0, nullptr);
+}
+
+void BindlessDescriptorSet::free(BindlessResourceType type, uint32_t index)
+{
+    if (index == HRI_BINDLESS_INVALID_INDEX)
+        return;
+
+    IndexAllocator& allocator = m_allocators[static_cast<size_t>(type)];
+    assert(index < allocator.nextIndex);
+    allocator.freeList.push_back(index);
+}
+
+void BindlessDescriptorSet::release()
+{
+    // Destroying the pool implicitly frees the bindless set
+    vkDestroyDescriptorPool(m_ctx.device, m_pool, nullptr);
+}
+
+uint32_t BindlessDescriptorSet::allocateIndex(BindlessResourceType type)
+{
+    IndexAllocator& allocator = m_allocators[static_cast<size_t>(type)];
+    if (!allocator.freeList.empty())
+    {
+        uint32_t index = allocator.freeList.back();
+        allocator.freeList.pop_back();
+        return index;
+    }
+
+    if (allocator.nextIndex >= allocator.capacity)
+    {
+        fprintf(stderr, "Bindless Descriptor Set exhausted for resource type %d\n", static_cast<int>(type));
+        abort();
+    }
+
+    return allocator.nextIndex++;
+}
@@ -47,6 +47,10 @@ ImageResource::ImageResource(
 	allocationInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
 	allocationInfo.preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 	allocationInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+	// Transient attachments never leave the render pass, tiled GPUs can back them with lazily allocated memory
+	if ((usage & VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT) != 0)
+		allocationInfo.preferredFlags |= VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
 	HRI_VK_CHECK(vmaCreateImage(m_ctx.allocator, &imageCreateInfo, &allocationInfo, &image, &m_allocation, nullptr));
 }
 
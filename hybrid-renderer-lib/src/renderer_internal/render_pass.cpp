@@ -1,5 +1,6 @@
 #include "renderer_internal/render_pass.h"
 
+#include <algorithm>
 #include <optional>
 #include <vector>
 #include <vk_mem_alloc.h>
@@ -9,6 +10,19 @@
 
 using namespace hri;
 
+VkExtent2D hri::overallocateExtent(VkExtent2D extent, VkExtent2D allocatedExtent)
+{
+	// 25% headroom, rounded up to a multiple of the granularity
+	constexpr uint32_t granularity = 64;
+	uint32_t width = ((extent.width + extent.width / 4 + granularity - 1) / granularity) * granularity;
+	uint32_t height = ((extent.height + extent.height / 4 + granularity - 1) / granularity) * granularity;
+
+	return VkExtent2D{
+		std::max(allocatedExtent.width, width),
+		std::max(allocatedExtent.height, height),
+	};
+}
+
 RenderPassBuilder::RenderPassBuilder(RenderContext& ctx)
 	:
 	m_ctx(ctx)
@@ -83,6 +97,9 @@ RenderPassBuilder& RenderPassBuilder::setAttachmentReference(AttachmentType type
 	case hri::AttachmentType::DepthStencil:
 		currentSubpass.depthStencilAttachment = ref;
 		break;
+	case hri::AttachmentType::Input:
+		currentSubpass.inputAttachments.push_back(ref);
+		break;
 	default:
 		break;
 	}
@@ -97,6 +114,8 @@ VkRenderPass RenderPassBuilder::build()
 	{
 		VkSubpassDescription description = VkSubpassDescription{};
 		description.flags = 0;
+		description.inputAttachmentCount = static_cast<uint32_t>(pass.inputAttachments.size());
+		description.pInputAttachments = pass.inputAttachments.data();
 		description.colorAttachmentCount = static_cast<uint32_t>(pass.colorAttachments.size());
 		description.pColorAttachments = pass.colorAttachments.data();
 		description.pDepthStencilAttachment = pass.depthStencilAttachment.has_value() ? &pass.depthStencilAttachment.value() : nullptr;
@@ -152,6 +171,22 @@ void IRenderPassResourceManagerBase::setClearValue(uint32_t attachmentIndex, VkC
 	m_clearValues[attachmentIndex] = clearValue;
 }
 
+VkImageView IRenderPassResourceManagerBase::getAttachmentLayerView(uint32_t attachmentIndex, uint32_t layer) const
+{
+	assert(attachmentIndex < m_imageResources.size());
+	const std::vector<VkImageView>& layerViews = m_layerViews[attachmentIndex];
+
+	// Single layer attachments are viewed directly
+	if (layerViews.empty())
+	{
+		assert(layer == 0);
+		return m_imageResources[attachmentIndex].view;
+	}
+
+	assert(layer < layerViews.size());
+	return layerViews[layer];
+}
+
 void IRenderPassResourceManagerBase::createResources()
 {
 	m_renderExtent = getRenderExtent();
@@ -164,27 +199,54 @@ void IRenderPassResourceManagerBase::createResources()
 			config.format,
 			config.samples,
 			VkExtent3D{ m_renderExtent.width, m_renderExtent.height, 1 },
-			1, 1,
+			1, config.layers,
 			config.usage
 		);
 
 		attachment.createView(
-			VK_IMAGE_VIEW_TYPE_2D,
+			(config.layers > 1) ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D,
 			ImageResource::DefaultComponentMapping(),
-			ImageResource::SubresourceRange(config.aspect, 0, 1, 0, 1)
+			ImageResource::SubresourceRange(config.aspect, 0, 1, 0, config.layers)
 		);
 
+		// Layered attachments get an additional view per layer for sampling
+		std::vector<VkImageView> layerViews = {};
+		for (uint32_t layer = 0; config.layers > 1 && layer < config.layers; layer++)
+		{
+			VkImageViewCreateInfo viewCreateInfo = VkImageViewCreateInfo{ VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO };
+			viewCreateInfo.flags = 0;
+			viewCreateInfo.image = attachment.image;
+			viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			viewCreateInfo.format = config.format;
+			viewCreateInfo.components = ImageResource::DefaultComponentMapping();
+			viewCreateInfo.subresourceRange = ImageResource::SubresourceRange(config.aspect, 0, 1, layer, 1);
+
+			VkImageView layerView = VK_NULL_HANDLE;
+			HRI_VK_CHECK(vkCreateImageView(m_ctx.device, &viewCreateInfo, nullptr, &layerView));
+			layerViews.push_back(layerView);
+		}
+
 		m_imageResources.push_back(std::move(attachment));
+		m_layerViews.push_back(layerViews);
 	}
 }
 
 void IRenderPassResourceManagerBase::destroyResources()
 {
+	for (auto const& layerViews : m_layerViews)
+	{
+		for (auto const& layerView : layerViews)
+		{
+			vkDestroyImageView(m_ctx.device, layerView, nullptr);
+		}
+	}
+
 	for (auto& attachment : m_imageResources)
 	{
 		attachment.destroyView();
 	}
 
+	m_layerViews.clear();
 	m_imageResources.clear();
 }
 
@@ -205,6 +267,17 @@ VkExtent2D IRenderPassResourceManagerBase::getRenderExtent() const
 	return m_ctx.swapchain.extent;
 }
 
+uint32_t IRenderPassResourceManagerBase::getFramebufferLayers() const
+{
+	uint32_t layers = 1;
+	for (auto const& config : m_attachmentConfigs)
+	{
+		layers = std::max(layers, config.layers);
+	}
+
+	return layers;
+}
+
 SwapchainPassResourceManager::SwapchainPassResourceManager(
 	RenderContext& ctx,
 	VkRenderPass renderPass,
@@ -292,9 +365,14 @@ RenderPassResourceManager::~RenderPassResourceManager()
 }
 
 void RenderPassResourceManager::beginRenderPass(ActiveFrame& frame) const
+{
+	beginRenderPass(frame, m_renderPass);
+}
+
+void RenderPassResourceManager::beginRenderPass(ActiveFrame& frame, VkRenderPass renderPass) const
 {
 	VkRenderPassBeginInfo passBeginInfo = VkRenderPassBeginInfo{ VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO };
-	passBeginInfo.renderPass = m_renderPass;
+	passBeginInfo.renderPass = renderPass;
 	passBeginInfo.framebuffer = m_framebuffer;
 	passBeginInfo.renderArea = VkRect2D{ VkOffset2D{ 0, 0 }, m_renderExtent };
 	passBeginInfo.clearValueCount = static_cast<uint32_t>(m_clearValues.size());
@@ -314,7 +392,7 @@ void RenderPassResourceManager::createResources()
 	fbCreateInfo.pAttachments = attachments.data();
 	fbCreateInfo.width = m_renderExtent.width;
 	fbCreateInfo.height = m_renderExtent.height;
-	fbCreateInfo.layers = 1;
+	fbCreateInfo.layers = getFramebufferLayers();
 	HRI_VK_CHECK(vkCreateFramebuffer(m_ctx.device, &fbCreateInfo, nullptr, &m_framebuffer));
 }
 
@@ -323,3 +401,188 @@ void RenderPassResourceManager::destroyResources()
 	IRenderPassResourceManagerBase::destroyResources();
 	vkDestroyFramebuffer(m_ctx.device, m_framebuffer, nullptr);
 }
+
+DynamicRenderingResourceManager::DynamicRenderingResourceManager(
+	RenderContext& ctx,
+	const std::vector<DynamicRenderingAttachmentInfo>& attachmentInfos,
+	const std::vector<RenderAttachmentConfig>& attachmentConfigs,
+	bool swapchainTarget
+)
+	:
+	hri::IRenderPassResourceManagerBase(ctx, VK_NULL_HANDLE, attachmentConfigs),
+	m_swapchainTarget(swapchainTarget),
+	m_attachmentInfos(attachmentInfos)
+{
+	assert(m_attachmentInfos.size() == m_attachmentConfigs.size() + (m_swapchainTarget ? 1 : 0));
+	assert(!m_swapchainTarget || m_attachmentInfos[0].loadOp != VK_ATTACHMENT_LOAD_OP_LOAD);
+
+	createResources();
+}
+
+DynamicRenderingResourceManager::~DynamicRenderingResourceManager()
+{
+	destroyResources();
+}
+
+void DynamicRenderingResourceManager::beginRenderPass(ActiveFrame& frame) const
+{
+	transitionAttachments(frame, true);
+
+	std::vector<VkRenderingAttachmentInfo> colorAttachments = {}; colorAttachments.reserve(m_attachmentInfos.size());
+	VkRenderingAttachmentInfo depthAttachment = VkRenderingAttachmentInfo{ VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO };
+	bool hasDepthAttachment = false;
+
+	for (size_t attachmentIndex = 0; attachmentIndex < m_attachmentInfos.size(); attachmentIndex++)
+	{
+		const DynamicRenderingAttachmentInfo& info = m_attachmentInfos[attachmentIndex];
+		const bool isSwapImage = m_swapchainTarget && attachmentIndex == 0;
+		const size_t resourceIndex = m_swapchainTarget ? attachmentIndex - 1 : attachmentIndex;
+		const bool isDepth = info.type == AttachmentType::DepthStencil;
+
+		VkRenderingAttachmentInfo attachment = VkRenderingAttachmentInfo{ VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO };
+		attachment.imageView = isSwapImage ? m_swapViews[frame.activeSwapImageIndex] : m_imageResources[resourceIndex].view;
+		attachment.imageLayout = isDepth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		attachment.resolveMode = VK_RESOLVE_MODE_NONE;
+		attachment.loadOp = info.loadOp;
+		attachment.storeOp = info.storeOp;
+		attachment.clearValue = (attachmentIndex < m_clearValues.size()) ? m_clearValues[attachmentIndex] : VkClearValue{{}};
+
+		if (isDepth)
+		{
+			depthAttachment = attachment;
+			hasDepthAttachment = true;
+		}
+		else
+		{
+			colorAttachments.push_back(attachment);
+		}
+	}
+
+	// Render area is the current extent, attachments may be larger than this
+	VkRenderingInfo renderingInfo = VkRenderingInfo{ VK_STRUCTURE_TYPE_RENDERING_INFO };
+	renderingInfo.flags = 0;
+	renderingInfo.renderArea = VkRect2D{ VkOffset2D{ 0, 0 }, m_renderExtent };
+	renderingInfo.layerCount = getFramebufferLayers();
+	renderingInfo.viewMask = 0;
+	renderingInfo.colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size());
+	renderingInfo.pColorAttachments = colorAttachments.data();
+	renderingInfo.pDepthAttachment = hasDepthAttachment ? &depthAttachment : nullptr;
+	renderingInfo.pStencilAttachment = nullptr;
+	vkCmdBeginRendering(frame.commandBuffer, &renderingInfo);
+}
+
+void DynamicRenderingResourceManager::endRenderPass(ActiveFrame& frame) const
+{
+	vkCmdEndRendering(frame.commandBuffer);
+	transitionAttachments(frame, false);
+}
+
+void DynamicRenderingResourceManager::recreateResources()
+{
+	VkExtent2D swapExtent = m_ctx.swapchain.extent;
+	if (swapExtent.width > m_allocatedExtent.width || swapExtent.height > m_allocatedExtent.height)
+	{
+		destroyResources();
+		createResources();
+		return;
+	}
+
+	// Attachments still fit, only the swap views & render area change
+	destroySwapViews();
+	createSwapViews();
+	m_renderExtent = swapExtent;
+}
+
+void DynamicRenderingResourceManager::createResources()
+{
+	IRenderPassResourceManagerBase::createResources();
+	createSwapViews();
+
+	m_allocatedExtent = m_renderExtent;
+	m_renderExtent = m_ctx.swapchain.extent;
+	m_attachmentLayouts = std::vector<VkImageLayout>(m_imageResources.size(), VK_IMAGE_LAYOUT_UNDEFINED);
+}
+
+void DynamicRenderingResourceManager::destroyResources()
+{
+	IRenderPassResourceManagerBase::destroyResources();
+	destroySwapViews();
+}
+
+VkExtent2D DynamicRenderingResourceManager::getRenderExtent() const
+{
+	return overallocateExtent(m_ctx.swapchain.extent, m_allocatedExtent);
+}
+
+void DynamicRenderingResourceManager::transitionAttachments(ActiveFrame& frame, bool beginRendering) const
+{
+	std::vector<VkImageMemoryBarrier2> barriers = {}; barriers.reserve(m_attachmentInfos.size());
+	for (size_t attachmentIndex = 0; attachmentIndex < m_attachmentInfos.size(); attachmentIndex++)
+	{
+		const DynamicRenderingAttachmentInfo& info = m_attachmentInfos[attachmentIndex];
+		const bool isSwapImage = m_swapchainTarget && attachmentIndex == 0;
+		const size_t resourceIndex = m_swapchainTarget ? attachmentIndex - 1 : attachmentIndex;
+		const bool isDepth = info.type == AttachmentType::DepthStencil;
+
+		const VkImageLayout attachmentLayout = isDepth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		const VkPipelineStageFlags2 attachmentStages = isDepth
+			? VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT
+			: VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+		const VkAccessFlags2 attachmentAccess = isDepth
+			? VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
+			: VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+
+		VkImageMemoryBarrier2 barrier = VkImageMemoryBarrier2{ VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2 };
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = isSwapImage ? m_swapImages[frame.activeSwapImageIndex] : m_imageResources[resourceIndex].image;
+		barrier.subresourceRange = isSwapImage
+			? ImageResource::SubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1)
+			: ImageResource::SubresourceRange(m_attachmentConfigs[resourceIndex].aspect, 0, 1, 0, m_attachmentConfigs[resourceIndex].layers);
+
+		if (beginRendering)
+		{
+			// Cleared or discarded attachments don't need their previous contents
+			const bool preserveContents = info.loadOp == VK_ATTACHMENT_LOAD_OP_LOAD && !isSwapImage;
+			barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			barrier.dstStageMask = attachmentStages;
+			barrier.srcAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+			barrier.dstAccessMask = attachmentAccess;
+			barrier.oldLayout = preserveContents ? m_attachmentLayouts[resourceIndex] : VK_IMAGE_LAYOUT_UNDEFINED;
+			barrier.newLayout = attachmentLayout;
+		}
+		else
+		{
+			barrier.srcStageMask = attachmentStages;
+			barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			barrier.srcAccessMask = attachmentAccess;
+			barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+			barrier.oldLayout = attachmentLayout;
+			barrier.newLayout = info.finalLayout;
+
+			if (!isSwapImage)
+				m_attachmentLayouts[resourceIndex] = info.finalLayout;
+		}
+
+		barriers.push_back(barrier);
+	}
+
+	frame.pipelineBarrier(barriers);
+}
+
+void DynamicRenderingResourceManager::createSwapViews()
+{
+	if (!m_swapchainTarget)
+		return;
+
+	m_swapImages = m_ctx.swapchain.get_images().value();
+	m_swapViews = m_ctx.swapchain.get_image_views().value();
+}
+
+void DynamicRenderingResourceManager::destroySwapViews()
+{
+	m_ctx.swapchain.destroy_image_views(m_swapViews);
+
+	m_swapImages.clear();
+	m_swapViews.clear();
+}
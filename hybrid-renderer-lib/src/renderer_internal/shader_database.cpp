@@ -1,12 +1,18 @@
 #include "renderer_internal/shader_database.h"
 
+#include <cinttypes>
+#include <chrono>
 #include <cstdio>
+#include <filesystem>
+#include <future>
+#include <memory>
 #include <string>
 #include <map>
 #include <vector>
 #include <vulkan/vulkan.h>
 
 #include "renderer_internal/render_context.h"
+#include "renderer_internal/shader_pack.h"
 
 using namespace hri;
 
@@ -147,6 +153,19 @@ VkPipelineColorBlendStateCreateInfo GraphicsPipelineBuilder::initColorBlendState
     };
 }
 
+VkPipelineRenderingCreateInfo GraphicsPipelineBuilder::initRenderingCreateInfo(const std::vector<VkFormat>& colorFormats, VkFormat depthFormat)
+{
+    return VkPipelineRenderingCreateInfo{
+        VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+        nullptr,
+        0,
+        static_cast<uint32_t>(colorFormats.size()),
+        colorFormats.data(),
+        depthFormat,
+        VK_FORMAT_UNDEFINED,
+    };
+}
+
 Shader::Shader(RenderContext& ctx, const uint32_t* pCode, size_t codeSize, VkShaderStageFlagBits stage)
     :
     m_ctx(ctx),
@@ -170,7 +189,8 @@ Shader::Shader(Shader&& other) noexcept
     :
     m_ctx(other.m_ctx),
     stage(other.stage),
-    module(other.module)
+    module(other.module),
+    hash(other.hash)
 {
     other.module = VK_NULL_HANDLE;
 }
@@ -186,6 +206,7 @@ Shader& Shader::operator=(Shader&& other) noexcept
     m_ctx = std::move(other.m_ctx);
     stage = other.stage;
     module = other.module;
+    hash = other.hash;
 
     other.module = VK_NULL_HANDLE;
 
@@ -222,6 +243,7 @@ Shader Shader::loadFile(RenderContext& ctx, const std::string& path, VkShaderSta
 
     // Initialize shader
     Shader shader = Shader(ctx, reinterpret_cast<uint32_t*>(pCode), static_cast<size_t>(readBytes), stage);
+    shader.hash = fnv1a64(pCode, readBytes);
 
     // Free resources
     fclose(file);
@@ -230,6 +252,21 @@ Shader Shader::loadFile(RenderContext& ctx, const std::string& path, VkShaderSta
     return shader;
 }
 
+Shader Shader::loadPacked(RenderContext& ctx, const ShaderPack& pack, const std::string& entryName)
+{
+    const ShaderPackEntry* pEntry = pack.findEntry(entryName);
+    if (pEntry == nullptr)
+    {
+        fprintf(stderr, "Shader [%s] does not exist in Shader Pack!\n", entryName.c_str());
+        abort();
+    }
+
+    Shader shader = Shader(ctx, pack.code(*pEntry), pEntry->codeSize, static_cast<VkShaderStageFlagBits>(pEntry->stage));
+    shader.hash = pEntry->hash;
+
+    return shader;
+}
+
 void Shader::release()
 {
     vkDestroyShaderModule(m_ctx.device, module, nullptr);
@@ -239,20 +276,47 @@ ShaderDatabase::ShaderDatabase(RenderContext& ctx)
     :
     m_ctx(ctx)
 {
-    VkPipelineCacheCreateInfo cacheCreateInfo = VkPipelineCacheCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
-    cacheCreateInfo.flags = 0;
-    cacheCreateInfo.initialDataSize = 0;
-    cacheCreateInfo.pInitialData = nullptr;
-    HRI_VK_CHECK(vkCreatePipelineCache(m_ctx.device, &cacheCreateInfo, nullptr, &m_pipelineCache));
+    createPipelineCache("");
+}
+
+ShaderDatabase::ShaderDatabase(RenderContext& ctx, const std::string& shaderPackPath)
+    :
+    m_ctx(ctx),
+    m_shaderPack(std::make_unique<ShaderPack>(shaderPackPath))
+{
+    // Pack hash changes with any shader change, so stale caches are never loaded
+    char cacheSuffix[32] = {};
+    snprintf(cacheSuffix, sizeof(cacheSuffix), ".%016" PRIx64 ".cache", m_shaderPack->packHash());
+    m_pipelineCachePath = shaderPackPath + cacheSuffix;
+
+    createPipelineCache(m_pipelineCachePath);
 }
 
 ShaderDatabase::~ShaderDatabase()
 {
+    if (m_optimizeTask.valid())
+    {
+        for (auto const& link : m_optimizeTask.get())
+        {
+            vkDestroyPipeline(m_ctx.device, link.optimizedPipeline, nullptr);
+        }
+    }
+
+    if (!m_pipelineCachePath.empty())
+    {
+        savePipelineCache(m_pipelineCachePath);
+    }
+
     for (auto& [ name, pso ] : m_pipelineMap)
     {
         vkDestroyPipeline(m_ctx.device, pso.pipeline, nullptr);
     }
 
+    for (auto const& retired : m_retiredPipelines)
+    {
+        vkDestroyPipeline(m_ctx.device, retired.pipeline, nullptr);
+    }
+
     vkDestroyPipelineCache(m_ctx.device, m_pipelineCache, nullptr);
 }
 
@@ -273,6 +337,18 @@ Shader* ShaderDatabase::registerShader(const std::string& name, Shader&& shader)
     return &it->second;
 }
 
+Shader* ShaderDatabase::registerShader(const std::string& name, const std::string& packEntryName)
+{
+    assert(m_shaderPack != nullptr);
+
+    if (isExistingShader(name))
+    {
+        return getShader(name);
+    }
+
+    return registerShader(name, Shader::loadPacked(m_ctx, *m_shaderPack, packEntryName));
+}
+
 PipelineStateObject* ShaderDatabase::createPipeline(
     const std::string& name,
     const std::vector<std::string>& shaders,
@@ -325,8 +401,11 @@ PipelineStateObject* ShaderDatabase::createPipeline(
     dynamicState.dynamicStateCount = static_cast<uint32_t>(pipelineBuilder.dynamicStates.size());
     dynamicState.pDynamicStates = pipelineBuilder.dynamicStates.data();
 
+    VkPipelineRenderingCreateInfo renderingCreateInfo = GraphicsPipelineBuilder::initRenderingCreateInfo(pipelineBuilder.colorAttachmentFormats, pipelineBuilder.depthAttachmentFormat);
+
     // Create pipeline
     VkGraphicsPipelineCreateInfo pipelineCreateInfo = VkGraphicsPipelineCreateInfo{ VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+    pipelineCreateInfo.pNext = (pipelineBuilder.renderPass == VK_NULL_HANDLE) ? &renderingCreateInfo : nullptr;
     pipelineCreateInfo.flags = 0;
     pipelineCreateInfo.stageCount = static_cast<uint32_t>(pipelineStages.size());
     pipelineCreateInfo.pStages = pipelineStages.data();
@@ -363,10 +442,219 @@ PipelineStateObject* ShaderDatabase::createPipeline(
     return &it->second;
 }
 
+PipelineStateObject* ShaderDatabase::createPipelineLibrary(
+    const std::string& name,
+    VkGraphicsPipelineLibraryFlagsEXT libraryParts,
+    const std::vector<std::string>& shaders,
+    const GraphicsPipelineBuilder& pipelineBuilder
+)
+{
+    if (isExistingPipeline(name))
+    {
+        return getPipeline(name);
+    }
+
+    const bool vertexInput = (libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT) != 0;
+    const bool preRasterization = (libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT) != 0;
+    const bool fragmentShader = (libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT) != 0;
+    const bool fragmentOutput = (libraryParts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT) != 0;
+
+    // Create pipeline shader stages, only stages belonging to the requested parts are added
+    std::vector<VkPipelineShaderStageCreateInfo> pipelineStages;
+    pipelineStages.reserve(shaders.size());
+    for (auto const& shaderName : shaders)
+    {
+        const Shader* shader = getShader(shaderName);
+        assert(shader != nullptr);
+
+        const bool isFragmentStage = shader->stage == VK_SHADER_STAGE_FRAGMENT_BIT;
+        if ((isFragmentStage && !fragmentShader) || (!isFragmentStage && !preRasterization))
+            continue;
+
+        VkPipelineShaderStageCreateInfo pipelineShaderStage = VkPipelineShaderStageCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO };
+        pipelineShaderStage.flags = 0;
+        pipelineShaderStage.stage = shader->stage;
+        pipelineShaderStage.module = shader->module;
+        pipelineShaderStage.pName = "main";
+        pipelineShaderStage.pSpecializationInfo = nullptr;
+        pipelineStages.push_back(pipelineShaderStage);
+    }
+
+    // Create PSO object
+    PipelineStateObject pso = PipelineStateObject{};
+    pso.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+
+    // Generate pipeline state from builder
+    VkPipelineVertexInputStateCreateInfo vertexInputState = VkPipelineVertexInputStateCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
+    vertexInputState.flags = 0;
+    vertexInputState.vertexBindingDescriptionCount = static_cast<uint32_t>(pipelineBuilder.vertexInputBindings.size());
+    vertexInputState.pVertexBindingDescriptions = pipelineBuilder.vertexInputBindings.data();
+    vertexInputState.vertexAttributeDescriptionCount = static_cast<uint32_t>(pipelineBuilder.vertexInputAttributes.size());
+    vertexInputState.pVertexAttributeDescriptions = pipelineBuilder.vertexInputAttributes.data();
+
+    VkPipelineViewportStateCreateInfo viewportState = VkPipelineViewportStateCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };
+    viewportState.flags = 0;
+    viewportState.viewportCount = 1;
+    viewportState.pViewports = &pipelineBuilder.viewport;
+    viewportState.scissorCount = 1;
+    viewportState.pScissors = &pipelineBuilder.scissor;
+
+    VkPipelineDynamicStateCreateInfo dynamicState = VkPipelineDynamicStateCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO };
+    dynamicState.flags = 0;
+    dynamicState.dynamicStateCount = static_cast<uint32_t>(pipelineBuilder.dynamicStates.size());
+    dynamicState.pDynamicStates = pipelineBuilder.dynamicStates.data();
+
+    // Attachment formats are passed to all rendering dependent parts when no render pass is used
+    VkPipelineRenderingCreateInfo renderingCreateInfo = GraphicsPipelineBuilder::initRenderingCreateInfo(pipelineBuilder.colorAttachmentFormats, pipelineBuilder.depthAttachmentFormat);
+    const bool dynamicRendering = pipelineBuilder.renderPass == VK_NULL_HANDLE && (preRasterization || fragmentShader || fragmentOutput);
+
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo = VkGraphicsPipelineLibraryCreateInfoEXT{ VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT };
+    libraryCreateInfo.pNext = dynamicRendering ? &renderingCreateInfo : nullptr;
+    libraryCreateInfo.flags = libraryParts;
+
+    // Create pipeline library, state not used by the requested parts is left empty
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo = VkGraphicsPipelineCreateInfo{ VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+    pipelineCreateInfo.pNext = &libraryCreateInfo;
+    pipelineCreateInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+    pipelineCreateInfo.stageCount = static_cast<uint32_t>(pipelineStages.size());
+    pipelineCreateInfo.pStages = pipelineStages.data();
+    pipelineCreateInfo.pVertexInputState = vertexInput ? &vertexInputState : nullptr;
+    pipelineCreateInfo.pInputAssemblyState = vertexInput ? &pipelineBuilder.inputAssemblyState : nullptr;
+    pipelineCreateInfo.pTessellationState = nullptr;
+    pipelineCreateInfo.pViewportState = preRasterization ? &viewportState : nullptr;
+    pipelineCreateInfo.pRasterizationState = preRasterization ? &pipelineBuilder.rasterizationState : nullptr;
+    pipelineCreateInfo.pMultisampleState = (fragmentShader || fragmentOutput) ? &pipelineBuilder.multisampleState : nullptr;
+    pipelineCreateInfo.pDepthStencilState = fragmentShader ? &pipelineBuilder.depthStencilState : nullptr;
+    pipelineCreateInfo.pColorBlendState = fragmentOutput ? &pipelineBuilder.colorBlendState : nullptr;
+    pipelineCreateInfo.pDynamicState = &dynamicState;
+    pipelineCreateInfo.layout = (preRasterization || fragmentShader) ? pipelineBuilder.layout : VK_NULL_HANDLE;
+    pipelineCreateInfo.renderPass = (preRasterization || fragmentShader || fragmentOutput) ? pipelineBuilder.renderPass : VK_NULL_HANDLE;
+    pipelineCreateInfo.subpass = pipelineBuilder.subpass;
+    pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineCreateInfo.basePipelineIndex = 0;
+    HRI_VK_CHECK(vkCreateGraphicsPipelines(
+        m_ctx.device,
+        m_pipelineCache,
+        1,
+        &pipelineCreateInfo,
+        nullptr,
+        &pso.pipeline
+    ));
+
+    const auto& [ it, success ] = m_pipelineMap.insert(std::make_pair(name, pso));
+    if (!success)
+    {
+        fprintf(stderr, "Failed to register Pipeline [%s] in DB!\n", name.c_str());
+        abort();
+    }
+
+    return &it->second;
+}
+
+PipelineStateObject* ShaderDatabase::linkPipeline(
+    const std::string& name,
+    const std::vector<std::string>& libraries,
+    VkPipelineLayout layout,
+    bool linkTimeOptimization
+)
+{
+    if (isExistingPipeline(name))
+    {
+        return getPipeline(name);
+    }
+
+    std::vector<VkPipeline> libraryHandles;
+    libraryHandles.reserve(libraries.size());
+    for (auto const& libraryName : libraries)
+    {
+        const PipelineStateObject* library = getPipeline(libraryName);
+        assert(library->bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS);
+        libraryHandles.push_back(library->pipeline);
+    }
+
+    // Create PSO object
+    PipelineStateObject pso = PipelineStateObject{};
+    pso.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    pso.pipeline = createLinkedPipeline(libraryHandles, layout, linkTimeOptimization);
+
+    // Fast linked pipelines are usable immediately, the optimized relink is deferred
+    if (!linkTimeOptimization)
+    {
+        m_unoptimizedLinks.push_back(UnoptimizedLink{ name, libraryHandles, layout });
+    }
+
+    const auto& [ it, success ] = m_pipelineMap.insert(std::make_pair(name, pso));
+    if (!success)
+    {
+        fprintf(stderr, "Failed to register Pipeline [%s] in DB!\n", name.c_str());
+        abort();
+    }
+
+    return &it->second;
+}
+
+void ShaderDatabase::optimizeLinkedPipelines()
+{
+    if (m_optimizeTask.valid() || m_unoptimizedLinks.empty())
+    {
+        return;
+    }
+
+    // Pipeline libraries & cache are only read by the relink, so they can be shared with the render thread
+    m_optimizeTask = std::async(std::launch::async, [this, links = std::move(m_unoptimizedLinks)]() mutable {
+        for (auto& link : links)
+        {
+            link.optimizedPipeline = createLinkedPipeline(link.libraryHandles, link.layout, true);
+        }
+
+        return links;
+    });
+    m_unoptimizedLinks.clear();
+}
+
+bool ShaderDatabase::swapOptimizedPipelines(uint64_t frameIndex)
+{
+    // Frames recorded before the retire frame have all finished once the frames in flight have cycled
+    for (auto it = m_retiredPipelines.begin(); it != m_retiredPipelines.end();)
+    {
+        if (frameIndex < it->retireFrame + HRI_VK_FRAMES_IN_FLIGHT)
+        {
+            it++;
+            continue;
+        }
+
+        vkDestroyPipeline(m_ctx.device, it->pipeline, nullptr);
+        it = m_retiredPipelines.erase(it);
+    }
+
+    if (!m_optimizeTask.valid())
+    {
+        optimizeLinkedPipelines();
+        return false;
+    }
+
+    if (m_optimizeTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return false;
+    }
+
+    for (auto const& link : m_optimizeTask.get())
+    {
+        PipelineStateObject* pso = getPipeline(link.name);
+        m_retiredPipelines.push_back(RetiredPipeline{ pso->pipeline, frameIndex });
+        pso->pipeline = link.optimizedPipeline;
+    }
+
+    // Pipelines linked while the previous relink was running are picked up by a new one
+    optimizeLinkedPipelines();
+    return true;
+}
+
 PipelineStateObject* ShaderDatabase::createPipeline(
     const std::string& name,
     const std::string& computeShader,
-    VkPipelineLayout layout
+    VkPipelineLayout layout,
+    const VkSpecializationInfo* pSpecializationInfo
 )
 {
     if (isExistingPipeline(name))
@@ -383,7 +671,7 @@ PipelineStateObject* ShaderDatabase::createPipeline(
     shaderStage.stage = shader->stage;
     shaderStage.module = shader->module;
     shaderStage.pName = "main";
-    shaderStage.pSpecializationInfo = nullptr;
+    shaderStage.pSpecializationInfo = pSpecializationInfo;
 
     // Create PSO object
     PipelineStateObject pso = PipelineStateObject{};
@@ -466,6 +754,83 @@ PipelineStateObject* ShaderDatabase::getPipeline(const std::string& name)
     return &it->second;
 }
 
+void ShaderDatabase::createPipelineCache(const std::string& cachePath)
+{
+    std::vector<char> cacheData;
+    FILE* file = cachePath.empty() ? nullptr : fopen(cachePath.c_str(), "rb");
+    if (file != nullptr)
+    {
+        fseek(file, 0, SEEK_END);
+        long cacheSize = ftell(file);
+        fseek(file, 0, SEEK_SET);
+
+        if (cacheSize > 0)
+        {
+            cacheData.resize(static_cast<size_t>(cacheSize));
+            cacheData.resize(fread(cacheData.data(), sizeof(char), cacheData.size(), file));
+        }
+
+        fclose(file);
+    }
+
+    // Incompatible cache data (e.g. different driver) is ignored by the implementation
+    VkPipelineCacheCreateInfo cacheCreateInfo = VkPipelineCacheCreateInfo{ VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+    cacheCreateInfo.flags = 0;
+    cacheCreateInfo.initialDataSize = cacheData.size();
+    cacheCreateInfo.pInitialData = cacheData.empty() ? nullptr : cacheData.data();
+    HRI_VK_CHECK(vkCreatePipelineCache(m_ctx.device, &cacheCreateInfo, nullptr, &m_pipelineCache));
+}
+
+void ShaderDatabase::savePipelineCache(const std::string& cachePath) const
+{
+    size_t cacheSize = 0;
+    HRI_VK_CHECK(vkGetPipelineCacheData(m_ctx.device, m_pipelineCache, &cacheSize, nullptr));
+
+    std::vector<char> cacheData(cacheSize);
+    HRI_VK_CHECK(vkGetPipelineCacheData(m_ctx.device, m_pipelineCache, &cacheSize, cacheData.data()));
+
+    FILE* file = fopen(cachePath.c_str(), "wb");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "Failed to write Pipeline Cache [%s]\n", cachePath.c_str());
+        return;
+    }
+
+    fwrite(cacheData.data(), sizeof(char), cacheSize, file);
+    fclose(file);
+
+    removeStalePipelineCaches(cachePath);
+}
+
+void ShaderDatabase::removeStalePipelineCaches(const std::string& cachePath) const
+{
+    namespace fs = std::filesystem;
+
+    // Cache names are "<pack>.<pack hash>.cache", siblings with the same pack prefix & length belong to older packs
+    fs::path currentCache = fs::path(cachePath);
+    std::string cacheName = currentCache.filename().string();
+    std::string packPrefix = cacheName.substr(0, cacheName.rfind('.', cacheName.size() - sizeof(".cache")) + 1);
+    fs::path cacheDirectory = currentCache.has_parent_path() ? currentCache.parent_path() : fs::path(".");
+
+    std::error_code error;
+    for (auto const& entry : fs::directory_iterator(cacheDirectory, error))
+    {
+        std::string name = entry.path().filename().string();
+        if (name == cacheName
+            || name.size() != cacheName.size()
+            || name.compare(0, packPrefix.size(), packPrefix) != 0
+            || name.compare(name.size() - (sizeof(".cache") - 1), std::string::npos, ".cache") != 0)
+        {
+            continue;
+        }
+
+        if (!fs::remove(entry.path(), error))
+        {
+            fprintf(stderr, "Failed to remove stale Pipeline Cache [%s]\n", entry.path().string().c_str());
+        }
+    }
+}
+
 bool ShaderDatabase::isExistingShader(const std::string& name) const
 {
     return m_shaderMap.find(name) != m_shaderMap.end();
@@ -475,3 +840,34 @@ bool ShaderDatabase::isExistingPipeline(const std::string& name) const
 {
     return m_pipelineMap.find(name) != m_pipelineMap.end();
 }
+
+VkPipeline ShaderDatabase::createLinkedPipeline(
+    const std::vector<VkPipeline>& libraryHandles,
+    VkPipelineLayout layout,
+    bool linkTimeOptimization
+) const
+{
+    VkPipelineLibraryCreateInfoKHR libraryInfo = VkPipelineLibraryCreateInfoKHR{ VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR };
+    libraryInfo.libraryCount = static_cast<uint32_t>(libraryHandles.size());
+    libraryInfo.pLibraries = libraryHandles.data();
+
+    // All state is provided by the linked libraries
+    VkGraphicsPipelineCreateInfo pipelineCreateInfo = VkGraphicsPipelineCreateInfo{ VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO };
+    pipelineCreateInfo.pNext = &libraryInfo;
+    pipelineCreateInfo.flags = linkTimeOptimization ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+    pipelineCreateInfo.layout = layout;
+    pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineCreateInfo.basePipelineIndex = 0;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    HRI_VK_CHECK(vkCreateGraphicsPipelines(
+        m_ctx.device,
+        m_pipelineCache,
+        1,
+        &pipelineCreateInfo,
+        nullptr,
+        &pipeline
+    ));
+
+    return pipeline;
+}
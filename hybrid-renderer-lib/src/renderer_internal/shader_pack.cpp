@@ -0,0 +1,172 @@
+#include "renderer_internal/shader_pack.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+#include "platform.h"
+
+#if HRI_PLATFORM_WINDOWS == 1
+#include <windows.h>
+#elif HRI_PLATFORM_UNIX == 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace hri;
+
+/// @brief Map a file into memory as read only.
+/// @param path File path.
+/// @param size Output file size.
+/// @return A pointer to the mapped data, or nullptr on failure.
+static const void* mapFile(const std::string& path, size_t& size)
+{
+#if HRI_PLATFORM_WINDOWS == 1
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    size = static_cast<size_t>(fileSize.QuadPart);
+
+    // The view keeps the mapping & file alive, so both handles can be closed immediately
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr)
+        return nullptr;
+
+    const void* pData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    return pData;
+#elif HRI_PLATFORM_UNIX == 1
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat fileStat = {};
+    if (fstat(fd, &fileStat) != 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    size = static_cast<size_t>(fileStat.st_size);
+
+    // The mapping stays valid after closing the file descriptor
+    void* pData = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    return pData != MAP_FAILED ? pData : nullptr;
+#endif
+}
+
+/// @brief Unmap a file mapped using mapFile.
+/// @param pData Mapped data.
+/// @param size Mapped size.
+static void unmapFile(const void* pData, size_t size)
+{
+#if HRI_PLATFORM_WINDOWS == 1
+    UnmapViewOfFile(pData);
+#elif HRI_PLATFORM_UNIX == 1
+    munmap(const_cast<void*>(pData), size);
+#endif
+}
+
+ShaderPack::ShaderPack(const std::string& path)
+{
+    m_pData = mapFile(path, m_size);
+    if (m_pData == nullptr || m_size < sizeof(ShaderPackHeader))
+    {
+        fprintf(stderr, "Failed to map Shader Pack [%s]\n", path.c_str());
+        abort();
+    }
+
+    const ShaderPackHeader* pHeader = header();
+    if (pHeader->magic != HRI_SHADER_PACK_MAGIC || pHeader->version != HRI_SHADER_PACK_VERSION)
+    {
+        fprintf(stderr, "Invalid Shader Pack [%s] (magic %08X, version %u)\n", path.c_str(), pHeader->magic, pHeader->version);
+        abort();
+    }
+
+    // Index entries by name, entries point directly into the mapped pack
+    const ShaderPackEntry* pEntries = reinterpret_cast<const ShaderPackEntry*>(pHeader + 1);
+    assert(sizeof(ShaderPackHeader) + pHeader->entryCount * sizeof(ShaderPackEntry) <= m_size);
+
+    m_entries.reserve(pHeader->entryCount);
+    for (uint32_t entryIdx = 0; entryIdx < pHeader->entryCount; entryIdx++)
+    {
+        const ShaderPackEntry& entry = pEntries[entryIdx];
+        assert(entry.codeOffset + entry.codeSize <= m_size);
+        assert(entry.codeOffset % sizeof(uint32_t) == 0);
+
+        std::string name = std::string(entry.name, strnlen(entry.name, HRI_SHADER_PACK_MAX_NAME_LENGTH));
+        m_entries[name] = &entry;
+    }
+}
+
+ShaderPack::~ShaderPack()
+{
+    release();
+}
+
+ShaderPack::ShaderPack(ShaderPack&& other) noexcept
+    :
+    m_pData(other.m_pData),
+    m_size(other.m_size),
+    m_entries(std::move(other.m_entries))
+{
+    other.m_pData = nullptr;
+    other.m_size = 0;
+}
+
+ShaderPack& ShaderPack::operator=(ShaderPack&& other) noexcept
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+
+    release();
+    m_pData = other.m_pData;
+    m_size = other.m_size;
+    m_entries = std::move(other.m_entries);
+
+    other.m_pData = nullptr;
+    other.m_size = 0;
+
+    return *this;
+}
+
+const ShaderPackEntry* ShaderPack::findEntry(const std::string& name) const
+{
+    auto const& it = m_entries.find(name);
+    if (it == m_entries.end())
+        return nullptr;
+
+    return it->second;
+}
+
+const uint32_t* ShaderPack::code(const ShaderPackEntry& entry) const
+{
+    return reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(m_pData) + entry.codeOffset);
+}
+
+void ShaderPack::release()
+{
+    if (m_pData != nullptr)
+        unmapFile(m_pData, m_size);
+
+    m_pData = nullptr;
+    m_size = 0;
+    m_entries.clear();
+}
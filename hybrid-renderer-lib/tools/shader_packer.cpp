@@ -0,0 +1,154 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "renderer_internal/shader_pack.h"
+
+/// Build time tool that packs compiled SPIR-V files into a single shader pack (see hri::ShaderPack).
+/// Usage: hri-shader-packer <output pack> <input .spv files...>
+/// Entry names are the input file names without the .spv extension, the shader stage is derived from the source extension.
+
+struct PackInput
+{
+	hri::ShaderPackEntry entry;
+	std::vector<char> code;
+};
+
+/// @brief Get the shader stage for a shader source extension.
+/// @param name Entry name, e.g. "static.vert".
+/// @return The shader stage, or 0 if the extension is unknown.
+static uint32_t getShaderStage(const std::string& name)
+{
+	static const struct { const char* extension; VkShaderStageFlagBits stage; } stageExtensions[] = {
+		{ ".vert",	VK_SHADER_STAGE_VERTEX_BIT },
+		{ ".frag",	VK_SHADER_STAGE_FRAGMENT_BIT },
+		{ ".comp",	VK_SHADER_STAGE_COMPUTE_BIT },
+		{ ".rgen",	VK_SHADER_STAGE_RAYGEN_BIT_KHR },
+		{ ".rmiss",	VK_SHADER_STAGE_MISS_BIT_KHR },
+		{ ".rchit",	VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR },
+		{ ".rahit",	VK_SHADER_STAGE_ANY_HIT_BIT_KHR },
+	};
+
+	size_t extensionStart = name.find_last_of('.');
+	if (extensionStart == std::string::npos)
+		return 0;
+
+	std::string extension = name.substr(extensionStart);
+	for (auto const& stageExtension : stageExtensions)
+	{
+		if (extension == stageExtension.extension)
+			return static_cast<uint32_t>(stageExtension.stage);
+	}
+
+	return 0;
+}
+
+/// @brief Read a SPIR-V file into a pack input.
+/// @param path Input file path.
+/// @param input Pack input to fill.
+/// @return A boolean indicating success.
+static bool readInput(const std::string& path, PackInput& input)
+{
+	std::string fileName = path.substr(path.find_last_of("/\\") + 1);
+	std::string name = fileName.substr(0, fileName.rfind(".spv"));
+	if (name.size() >= HRI_SHADER_PACK_MAX_NAME_LENGTH)
+	{
+		fprintf(stderr, "Shader name too long [%s]\n", name.c_str());
+		return false;
+	}
+
+	input.entry = hri::ShaderPackEntry{};
+	strncpy(input.entry.name, name.c_str(), HRI_SHADER_PACK_MAX_NAME_LENGTH - 1);
+	input.entry.stage = getShaderStage(name);
+	if (input.entry.stage == 0)
+	{
+		fprintf(stderr, "Unknown shader stage for [%s]\n", path.c_str());
+		return false;
+	}
+
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Failed to open Shader File [%s]\n", path.c_str());
+		return false;
+	}
+
+	fseek(file, 0, SEEK_END);
+	long codeSize = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	input.code.resize(codeSize > 0 ? static_cast<size_t>(codeSize) : 0);
+	size_t readBytes = fread(input.code.data(), sizeof(char), input.code.size(), file);
+	fclose(file);
+
+	if (readBytes == 0 || readBytes != input.code.size() || readBytes % sizeof(uint32_t) != 0)
+	{
+		fprintf(stderr, "Failed to read Shader File [%s]\n", path.c_str());
+		return false;
+	}
+
+	input.entry.codeSize = static_cast<uint32_t>(readBytes);
+	input.entry.hash = hri::fnv1a64(input.code.data(), input.code.size());
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "Usage: %s <output pack> <input .spv files...>\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	std::vector<PackInput> inputs(argc - 2);
+	for (int argIdx = 2; argIdx < argc; argIdx++)
+	{
+		if (!readInput(argv[argIdx], inputs[argIdx - 2]))
+			return EXIT_FAILURE;
+	}
+
+	// Lay out code blocks after the index, aligned for direct use as SPIR-V words
+	hri::ShaderPackHeader header = hri::ShaderPackHeader{};
+	header.entryCount = static_cast<uint32_t>(inputs.size());
+	header.packHash = HRI_FNV1A_64_OFFSET_BASIS;
+
+	uint64_t codeOffset = sizeof(hri::ShaderPackHeader) + inputs.size() * sizeof(hri::ShaderPackEntry);
+	for (auto& input : inputs)
+	{
+		codeOffset = HRI_ALIGNED_SIZE(codeOffset, HRI_SHADER_PACK_CODE_ALIGNMENT);
+		input.entry.codeOffset = codeOffset;
+		codeOffset += input.entry.codeSize;
+
+		// Names & stages are included so renaming or restaging a shader also invalidates pipeline caches
+		header.packHash = hri::fnv1a64(input.entry.name, strnlen(input.entry.name, HRI_SHADER_PACK_MAX_NAME_LENGTH), header.packHash);
+		header.packHash = hri::fnv1a64(&input.entry.stage, sizeof(input.entry.stage), header.packHash);
+		header.packHash = hri::fnv1a64(&input.entry.hash, sizeof(input.entry.hash), header.packHash);
+	}
+
+	FILE* file = fopen(argv[1], "wb");
+	if (file == nullptr)
+	{
+		fprintf(stderr, "Failed to open Shader Pack [%s]\n", argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	fwrite(&header, sizeof(hri::ShaderPackHeader), 1, file);
+	for (auto const& input : inputs)
+		fwrite(&input.entry, sizeof(hri::ShaderPackEntry), 1, file);
+
+	const char padding[HRI_SHADER_PACK_CODE_ALIGNMENT] = {};
+	for (auto const& input : inputs)
+	{
+		size_t paddingSize = static_cast<size_t>(input.entry.codeOffset - ftell(file));
+		fwrite(padding, sizeof(char), paddingSize, file);
+		fwrite(input.code.data(), sizeof(char), input.code.size(), file);
+	}
+
+	fclose(file);
+	printf("Packed %u shaders into [%s]\n", header.entryCount, argv[1]);
+
+	return EXIT_SUCCESS;
+}